@@ -0,0 +1,134 @@
+#include "allocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+thread_local unsigned long long threadCount = 0;
+
+void *countedAllocate(std::size_t size)
+{
+    AllocationCounter::record();
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *countedAllocate(std::size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::record();
+    std::size_t align = static_cast<std::size_t>(alignment);
+    void *memory = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+}
+
+std::atomic<unsigned long long> AllocationCounter::count(0);
+
+unsigned long long AllocationCounter::getCount()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+unsigned long long AllocationCounter::getThreadCount()
+{
+    return threadCount;
+}
+
+void AllocationCounter::record()
+{
+    count.fetch_add(1, std::memory_order_relaxed);
+    threadCount++;
+}
+
+void *operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return countedAllocate(size);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocate(size, alignment);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
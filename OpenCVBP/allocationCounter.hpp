@@ -0,0 +1,43 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class AllocationCounter
+ * @brief Counts heap allocations made through the global operator new.
+ *
+ * allocationCounter.cpp replaces the global operator new/delete family so every allocation in
+ * the process is counted, including those made inside OpenCV (a cv::Mat allocation creates
+ * its UMatData through operator new, so Mat buffers are counted as well). Counting costs one
+ * relaxed atomic increment per allocation.
+ */
+class AllocationCounter
+{
+public:
+    /**
+     * @brief Returns the number of allocations made by all threads since program start.
+     *
+     * @return The process-wide allocation count.
+     */
+    static unsigned long long getCount();
+
+    /**
+     * @brief Returns the number of allocations made by the calling thread since it started.
+     *
+     * @return The allocation count of the calling thread.
+     */
+    static unsigned long long getThreadCount();
+
+    /**
+     * @brief Records one allocation. Called by the replaced operator new.
+     */
+    static void record();
+
+private:
+    /** Process-wide allocation count. */
+    static std::atomic<unsigned long long> count;
+};
+
+#endif
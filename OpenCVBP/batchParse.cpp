@@ -1,5 +1,37 @@
 #include "batchParser.hpp"
 
+#include <cstring>
+
+namespace
+{
+const size_t maxTokens = 16;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// The words are views into one line, so the shape name is the text from the first to the last word.
+ShapeClass findShape(const std::string_view *words, size_t count)
+{
+    const char *begin = words[0].data();
+    const char *end = words[count - 1].data() + words[count - 1].size();
+    return ShapeClassifier::shapeClassFromName(std::string_view(begin, end - begin));
+}
+
+std::string joinWords(const std::string_view *words, size_t count)
+{
+    std::string text;
+    for (size_t w = 0; w < count; w++)
+    {
+        if (w > 0)
+            text += ' ';
+        text.append(words[w].data(), words[w].size());
+    }
+    return text;
+}
+}
+
 BatchParser::BatchParser()
 {
 }
@@ -8,39 +40,165 @@ BatchParser::~BatchParser()
 {
 }
 
-void BatchParser::processBatchFile(const std::string filePath)
+bool BatchParser::processBatchFile(const std::string &filePath, ResultSink &sink)
 {
-    Detector detector;
-    std::ifstream file(filePath);
-    std::string line;
+    BatchPlan plan;
+    if (!compile(filePath, plan))
+    {
+        return false;
+    }
 
-    while (std::getline(file, line))
+    for (const BatchDiagnostic &diagnostic : plan.diagnostics)
     {
-        if (line.empty() || line[0] == '#')
-            continue;
+        std::cerr << filePath << ':' << diagnostic.line << ": " << diagnostic.message << '\n';
+    }
+    std::cerr.flush();
+
+    std::vector<BatchDiagnostic> failures;
+    execute(plan, sink, failures);
+    for (const BatchDiagnostic &failure : failures)
+    {
+        std::cerr << filePath << ':' << failure.line << ": " << failure.message << '\n';
+    }
+    std::cerr.flush();
+
+    return plan.diagnostics.empty() && failures.empty();
+}
+
+bool BatchParser::compile(const std::string &filePath, BatchPlan &plan)
+{
+    MappedFile file;
+    if (!file.open(filePath))
+    {
+        return false;
+    }
+
+    const char *text = file.data();
+    const char *end = text + file.size();
+    unsigned line = 0;
+    sourceIndex.clear();
 
-        std::size_t commentPos = line.find('#');
-        if (commentPos != std::string::npos)
+    while (text < end)
+    {
+        const char *lineEnd = static_cast<const char *>(std::memchr(text, '\n', end - text));
+        if (!lineEnd)
         {
-            line = line.substr(0, commentPos);
+            lineEnd = end;
         }
 
-        std::istringstream iss(line);
-        std::vector<std::string> words(std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>());
+        compileLine(std::string_view(text, lineEnd - text), ++line, plan);
+        text = lineEnd + 1;
+    }
 
-        if (words.size() < 2)
-            continue;
+    sourceIndex.clear();
+    return true;
+}
 
-        std::string color = words.back();
-        words.pop_back();
-        std::string shape = std::accumulate(std::next(words.begin()), words.end(), words[0],
-                                            [](std::string a, std::string b)
-                                            { return std::move(a) + ' ' + std::move(b); });
+void BatchParser::compileLine(std::string_view text, unsigned line, BatchPlan &plan)
+{
+    size_t comment = text.find('#');
+    if (comment != std::string_view::npos)
+    {
+        text = text.substr(0, comment);
+    }
 
-        std::transform(shape.begin(), shape.end(), shape.begin(), ::tolower);
-        std::transform(color.begin(), color.end(), color.begin(), ::tolower);
-        detector.BatchMode(shape, color);
+    std::string_view words[maxTokens];
+    size_t count = 0;
+    size_t position = 0;
+    while (position < text.size())
+    {
+        while (position < text.size() && isSpace(text[position]))
+            position++;
+        size_t begin = position;
+        while (position < text.size() && !isSpace(text[position]))
+            position++;
+        if (position == begin)
+            break;
+        if (count == maxTokens)
+        {
+            plan.diagnostics.push_back({line, "too many words"});
+            return;
+        }
+        words[count++] = text.substr(begin, position - begin);
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+    if (count < 2)
+    {
+        plan.diagnostics.push_back({line, "expected '[source] shape color', got '" + joinWords(words, count) + "'"});
+        return;
+    }
+
+    BatchCommand command;
+    command.line = line;
+    command.color = ColorTable::shared().find(words[count - 1]);
+
+    // The words before the color are the shape, unless they only form a shape without the first word.
+    size_t shapeBegin = 0;
+    command.shape = findShape(words, count - 1);
+    if (command.shape == ShapeClass::None && count > 2)
+    {
+        shapeBegin = 1;
+        command.shape = findShape(words + 1, count - 2);
+    }
+
+    if (command.shape == ShapeClass::None)
+    {
+        // Report the shape as the user most likely meant it: everything after a path-like source.
+        shapeBegin = count > 2 && words[0].find_first_of("/.") != std::string_view::npos ? 1 : 0;
+        plan.diagnostics.push_back({line, "unknown shape '" + joinWords(words + shapeBegin, count - 1 - shapeBegin) + "'"});
+        return;
+    }
+    if (command.color == ColorTable::none)
+    {
+        plan.diagnostics.push_back({line, "unknown color '" + joinWords(words + count - 1, 1) + "'"});
+        return;
+    }
 
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+    command.source = findSource(shapeBegin == 1 ? words[0] : std::string_view(), plan);
+    plan.commands.push_back(command);
+}
+
+unsigned BatchParser::findSource(std::string_view location, BatchPlan &plan)
+{
+    auto found = sourceIndex.find(location);
+    if (found != sourceIndex.end())
+    {
+        return found->second;
+    }
+
+    unsigned index = static_cast<unsigned>(plan.sources.size());
+    plan.sources.emplace_back(location);
+    sourceIndex.emplace(location, index);
+    return index;
+}
+
+void BatchParser::execute(const BatchPlan &plan, ResultSink &sink, std::vector<BatchDiagnostic> &failures)
+{
+    Detector detector;
+    detector.setResultSink(&sink);
+
+    std::vector<std::unique_ptr<FrameSource>> sources(plan.sources.size());
+    std::vector<bool> opened(plan.sources.size(), false);
+    for (const BatchCommand &command : plan.commands)
+    {
+        std::unique_ptr<FrameSource> &source = sources[command.source];
+        if (!source)
+        {
+            source = std::make_unique<FrameSource>();
+            opened[command.source] = source->open(plan.sources[command.source]);
+        }
+        if (!opened[command.source])
+        {
+            const std::string &location = plan.sources[command.source];
+            failures.push_back({command.line, "could not open source '" + (location.empty() ? std::string("0") : location) + "'"});
+            continue;
+        }
+        detector.BatchMode(*source, command.shape, command.color);
     }
+
+    sink.flush();
 }
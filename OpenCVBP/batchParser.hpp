@@ -1,17 +1,66 @@
 #ifndef BATCHPARSER_H
 #define BATCHPARSER_H
 
-#include <fstream>
 #include <iostream>
-#include <sstream>
-#include <thread>
 #include <string>
-#include <chrono>
-#include <iterator>
-#include <numeric>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
 
 #include <opencv2/opencv.hpp>
 #include "detector.hpp"
+#include "frameSource.hpp"
+#include "resultSink.hpp"
+#include "mappedFile.hpp"
+
+/**
+ * @struct BatchCommand
+ * @brief One compiled batch command: detect a shape class of a color class in a source.
+ */
+struct BatchCommand
+{
+    /** Index of the source in BatchPlan::sources. */
+    unsigned source = 0;
+
+    /** The shape to detect. */
+    ShapeClass shape = ShapeClass::None;
+
+    /** The color class to detect (see ColorTable). */
+    uchar color = ColorTable::none;
+
+    /** Line of the command in the batch file, starting at 1. */
+    unsigned line = 0;
+};
+
+/**
+ * @struct BatchDiagnostic
+ * @brief A line of the batch file that could not be compiled, and why.
+ */
+struct BatchDiagnostic
+{
+    /** Line in the batch file, starting at 1. */
+    unsigned line = 0;
+
+    /** Description of the problem. */
+    std::string message;
+};
+
+/**
+ * @struct BatchPlan
+ * @brief A batch file compiled into commands that execute without touching the file's text.
+ */
+struct BatchPlan
+{
+    /** Distinct source locations, "" for the default camera. */
+    std::vector<std::string> sources;
+
+    /** The valid commands in file order. */
+    std::vector<BatchCommand> commands;
+
+    /** The lines that were skipped. */
+    std::vector<BatchDiagnostic> diagnostics;
+};
 
 /**
  * @class BatchParser
@@ -21,6 +70,10 @@
  * detection commands, process each command, and invoke the shape detection
  * functionality accordingly. Each line in the file represents a separate command
  * specifying a shape and its color to be detected.
+ *
+ * Batch files can run to hundreds of thousands of lines, so the file is memory mapped and
+ * tokenized in place without allocating, and compiled up front into a BatchPlan of enum typed
+ * commands. Invalid lines are reported before anything runs.
  */
 class BatchParser
 {
@@ -29,19 +82,70 @@ public:
     virtual ~BatchParser();
 
     /**
-     * @brief Processes a batch file containing shape detection commands.
-     *
-     * This method reads a specified file line by line, parsing each line to extract
-     * shape detection commands. Each command specifies a shape and a color. The method
-     * handles comments and invalid lines gracefully, ignoring them. For each valid command,
-     * it invokes the shape detection functionality of the Detector class.
+     * @brief Compiles and executes a batch file; see compile() and execute().
      *
-     * Lines can contain comments (starting with '#'), and inline comments are supported.
-     * The shape and color are case-insensitively processed to ensure flexibility in command formatting.
+     * Diagnostics are printed to standard error as "file:line: message"; the valid commands
+     * still run. Commands on a source that cannot be opened are reported the same way.
      *
      * @param filePath The path to the batch file containing shape detection commands.
+     * @param sink Receives one record per detection; flushed when the file is done.
+     * @return False if the file could not be read, contained invalid lines or named a source that could not be opened.
      */
-    void processBatchFile(const std::string filePath);
+    bool processBatchFile(const std::string &filePath, ResultSink &sink);
+
+    /**
+     * @brief Compiles a batch file into a plan.
+     *
+     * Each line specifies an optional input source, a shape and a color:
+     *
+     *     [source] shape color
+     *
+     * The source is an image file, a directory of images or a video file. Commands without
+     * a source use the default camera. Lines can contain comments (starting with '#'), and
+     * inline comments are supported. Shapes and colors are matched case-insensitively; lines
+     * with an unknown shape or color, or too few words, become diagnostics.
+     *
+     * @param filePath The path to the batch file.
+     * @param plan Receives the compiled commands, sources and diagnostics.
+     * @return False if the file could not be read.
+     */
+    bool compile(const std::string &filePath, BatchPlan &plan);
+
+    /**
+     * @brief Executes a compiled plan.
+     *
+     * Every source is opened once and reused by all commands that name it, and commands run
+     * back to back without any GUI or delay, in the headless batch mode of the Detector class.
+     *
+     * Commands whose source cannot be opened are skipped, with a diagnostic each.
+     *
+     * @param plan The compiled plan.
+     * @param sink Receives one record per detection; flushed at the end.
+     * @param failures Receives a diagnostic for every command whose source could not be opened.
+     */
+    void execute(const BatchPlan &plan, ResultSink &sink, std::vector<BatchDiagnostic> &failures);
+
+private:
+    /**
+     * @brief Compiles one line into a command or a diagnostic.
+     *
+     * @param text The line without its line break.
+     * @param line The line number.
+     * @param plan The plan to add to.
+     */
+    void compileLine(std::string_view text, unsigned line, BatchPlan &plan);
+
+    /**
+     * @brief Returns the index of a source location, adding it on first use.
+     *
+     * @param location The location as written in the batch file.
+     * @param plan The plan whose sources are searched.
+     * @return The index in BatchPlan::sources.
+     */
+    unsigned findSource(std::string_view location, BatchPlan &plan);
+
+    /** Source indices by location; the keys view the mapped file and are only valid during compile(). */
+    std::unordered_map<std::string_view, unsigned> sourceIndex;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,334 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "detector.hpp"
+#include "sceneGenerator.hpp"
+
+namespace
+{
+double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(fraction * (values.size() - 1) + 0.5)];
+}
+
+void printStage(const std::string &name, const std::vector<double> &seconds)
+{
+    double sum = 0.0;
+    for (double value : seconds)
+    {
+        sum += value;
+    }
+
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << 1000 * sum / std::max<size_t>(1, seconds.size())
+              << std::setw(10) << 1000 * percentile(seconds, 0.5)
+              << std::setw(10) << 1000 * percentile(seconds, 0.9)
+              << std::setw(10) << 1000 * percentile(seconds, 0.99)
+              << std::setw(10) << 1000 * percentile(seconds, 1.0) << '\n';
+}
+
+void printUsage()
+{
+    std::cout << "Usage: ShapeDetectorBench [options]\n"
+              << "  --width <px>        scene width (default 1280)\n"
+              << "  --height <px>       scene height (default 720)\n"
+              << "  --shapes <n>        shapes per scene (default 20)\n"
+              << "  --shape-types <l>   comma separated shapes, e.g. vierkant,cirkel (default all)\n"
+              << "  --colors <l>        comma separated colors, e.g. roze,geel (default all)\n"
+              << "  --noise <sigma>     Gaussian noise per channel (default 0)\n"
+              << "  --scenes <n>        distinct scenes to cycle through (default 8)\n"
+              << "  --frames <n>        measured frames (default 200)\n"
+              << "  --warmup <n>        unmeasured warm-up frames (default 10)\n"
+              << "  --seed <n>          random seed (default 1)\n"
+              << "  --replay <f>        measure on the frames of a recording instead of synthetic scenes\n"
+              << "  --color-config <f> color classes file (default: built-in classes)\n"
+              << "  --profile <f>       tuned profile written by ShapeDetectorTune (default: none)\n"
+              << "  --segmentation <s> edges or labels (default edges)\n"
+              << "  --pyramid <n>       find candidates at 1/2^n resolution first (default 0, off)\n"
+              << "  --track <n>         search only around tracked shapes, full search every n frames\n"
+              << "  --trace <file>      write a Chrome trace of the measured frames (needs make TRACE=1)\n";
+}
+}
+
+int main(int argc, char **argv)
+{
+    SceneConfig sceneConfig;
+    int scenes = 8;
+    int frames = 200;
+    int warmup = 10;
+    std::string tracePath;
+    std::string replayPath;
+    TrackingConfig tracking;
+    Segmentation segmentation = Segmentation::Edges;
+    int pyramidLevels = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--help" || i + 1 >= argc)
+        {
+            printUsage();
+            return option == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+
+        try
+        {
+            if (option == "--width")
+                sceneConfig.size.width = std::stoi(value);
+            else if (option == "--height")
+                sceneConfig.size.height = std::stoi(value);
+            else if (option == "--shapes")
+                sceneConfig.shapes = std::stoi(value);
+            else if (option == "--shape-types")
+                sceneConfig.shapeNames = splitList(value);
+            else if (option == "--colors")
+                sceneConfig.colors = splitList(value);
+            else if (option == "--noise")
+                sceneConfig.noise = std::stod(value);
+            else if (option == "--scenes")
+                scenes = std::max(1, std::stoi(value));
+            else if (option == "--frames")
+                frames = std::max(1, std::stoi(value));
+            else if (option == "--warmup")
+                warmup = std::max(0, std::stoi(value));
+            else if (option == "--seed")
+                sceneConfig.seed = std::stoull(value);
+            else if (option == "--trace")
+                tracePath = value;
+            else if (option == "--replay")
+                replayPath = value;
+            else if (option == "--color-config")
+            {
+                if (!ColorTable::shared().load(value))
+                    return 1;
+            }
+            else if (option == "--profile")
+            {
+                if (!DetectorProfile::shared().load(value))
+                    return 1;
+                if (!DetectorProfile::shared().getColors().empty())
+                    ColorTable::shared().setClasses(DetectorProfile::shared().getColors());
+            }
+            else if (option == "--segmentation")
+            {
+                if (value != "edges" && value != "labels")
+                {
+                    std::cerr << "Invalid segmentation: " << value << std::endl;
+                    return 1;
+                }
+                segmentation = value == "labels" ? Segmentation::ColorLabels : Segmentation::Edges;
+            }
+            else if (option == "--pyramid")
+                pyramidLevels = std::stoi(value);
+            else if (option == "--track")
+            {
+                tracking.enabled = true;
+                tracking.fullSearchInterval = std::max(1, std::stoi(value));
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+        catch (const std::logic_error &)
+        {
+            std::cerr << "Invalid value for option " << option << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    // Aliases are accepted, the scene generator draws by canonical name.
+    for (std::string &shape : sceneConfig.shapeNames)
+    {
+        if (!Detector::isKnownShape(shape))
+        {
+            std::cerr << "Invalid shape: " << shape << std::endl;
+            return 1;
+        }
+        shape = ShapeClassifier::getShapeClassKey(ShapeClassifier::shapeClassFromName(shape));
+    }
+    for (std::string &color : sceneConfig.colors)
+    {
+        if (!Detector::isKnownColor(color))
+        {
+            std::cerr << "Invalid color: " << color << std::endl;
+            return 1;
+        }
+        color = ColorTable::shared().getName(ColorTable::shared().find(color));
+    }
+
+    // A recording is replayed without decoding or copying, so every run sees the same pixels;
+    // it has no ground truth, so recall is only reported for synthetic scenes.
+    FrameRecording recording;
+    if (!replayPath.empty())
+    {
+        if (!recording.open(replayPath) || recording.size() == 0)
+        {
+            return 1;
+        }
+        scenes = static_cast<int>(recording.size());
+    }
+
+    SceneGenerator generator(sceneConfig);
+    std::vector<cv::Mat> images(scenes);
+    std::vector<std::vector<SceneShape>> truths(scenes);
+    for (int i = 0; i < scenes; i++)
+    {
+        if (!replayPath.empty())
+        {
+            images[i] = recording.frame(i);
+        }
+        else
+        {
+            generator.generate(images[i], truths[i]);
+        }
+    }
+
+    std::vector<Query> queries;
+    for (const std::string &shape : sceneConfig.shapeNames)
+    {
+        for (const std::string &color : sceneConfig.colors)
+        {
+            queries.push_back(Query{ShapeClassifier::shapeClassFromName(shape), ColorTable::shared().find(color)});
+        }
+    }
+
+    Detector detector;
+    detector.setAnnotate(false);
+    detector.setSegmentation(segmentation);
+    detector.setPyramidLevels(pyramidLevels);
+    detector.setTracking(tracking);
+
+    std::vector<double> preprocess, edges, contours, classify, answer, total;
+    std::vector<double> allocations;
+    std::vector<double> arenaAllocations, arenaBytes;
+    RejectStats rejects;
+    size_t expected = 0;
+    size_t found = 0;
+
+    for (int frame = 0; frame < warmup; frame++)
+    {
+        detector.detectShapes(images[frame % scenes], queries);
+    }
+
+    int64 benchBegin = cv::getTickCount();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        int scene = frame % scenes;
+        detector.detectShapes(images[scene], queries);
+
+        const FrameTimings &timings = detector.getFrameTimings();
+        preprocess.push_back(timings.preprocess);
+        edges.push_back(timings.edges);
+        contours.push_back(timings.contours);
+        classify.push_back(timings.classify);
+        answer.push_back(timings.queries);
+        total.push_back(timings.total);
+        allocations.push_back(static_cast<double>(detector.getFrameAllocations()));
+        arenaAllocations.push_back(static_cast<double>(detector.getArenaStats().allocations));
+        arenaBytes.push_back(static_cast<double>(detector.getArenaStats().bytes));
+
+        const RejectStats &frameRejects = detector.getRejectStats();
+        rejects.contours += frameRejects.contours;
+        rejects.points += frameRejects.points;
+        rejects.boundingBox += frameRejects.boundingBox;
+        rejects.area += frameRejects.area;
+        rejects.convexity += frameRejects.convexity;
+        rejects.unclassified += frameRejects.unclassified;
+
+        const DetectionStore &detections = detector.getDetections();
+        for (const SceneShape &truth : truths[scene])
+        {
+            // Only a detection of the same shape and color counts, not any neighbour inside the box.
+            expected++;
+            ShapeClass truthClass = ShapeClassifier::shapeClassFromName(truth.shape);
+            uchar truthColor = ColorTable::shared().find(truth.color);
+            for (size_t d : detections.matched())
+            {
+                if (truth.boundingRect.contains(detections.getCentroid(d)) && detections.getShapeClass(d) == truthClass &&
+                    detections.getColor(d) == truthColor)
+                {
+                    found++;
+                    break;
+                }
+            }
+        }
+    }
+    double elapsed = (cv::getTickCount() - benchBegin) / cv::getTickFrequency();
+
+    if (!replayPath.empty())
+    {
+        std::cout << "Replay: " << replayPath << ", " << scenes << " recorded frames, " << queries.size() << " queries, "
+                  << frames << " frames (+" << warmup << " warm-up), " << cv::getNumThreads() << " threads\n\n";
+    }
+    else
+    {
+        std::cout << "Scene: " << sceneConfig.size.width << "x" << sceneConfig.size.height << ", " << sceneConfig.shapes
+                  << " shapes, noise " << sceneConfig.noise << ", " << scenes << " scenes, " << queries.size() << " queries, "
+                  << frames << " frames (+" << warmup << " warm-up), " << cv::getNumThreads() << " threads\n\n";
+    }
+
+    std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << '\n';
+    printStage("preprocess", preprocess);
+    printStage("edges", edges);
+    printStage("contours", contours);
+    printStage("classify", classify);
+    printStage("queries", answer);
+    printStage("total", total);
+
+    double allocationSum = 0.0;
+    for (double value : allocations)
+    {
+        allocationSum += value;
+    }
+    double arenaAllocationSum = 0.0;
+    for (double value : arenaAllocations)
+    {
+        arenaAllocationSum += value;
+    }
+
+    std::cout << '\n'
+              << "Throughput:  " << std::setprecision(1) << frames / elapsed << " frames/s\n"
+              << "Allocations: " << std::setprecision(1) << allocationSum / frames << " per frame (p50 "
+              << std::setprecision(0) << percentile(allocations, 0.5) << ", max " << percentile(allocations, 1.0) << ")\n"
+              << "Arena:       " << std::setprecision(1) << arenaAllocationSum / frames << " contours per frame, max "
+              << std::setprecision(1) << percentile(arenaBytes, 1.0) / 1024 << " KiB, "
+              << detector.getArenaStats().capacity / 1024 << " KiB reserved\n"
+              << "Rejected:    " << std::setprecision(1) << 100.0 * rejects.rejected() / std::max(1ull, rejects.contours)
+              << "% of contours (points " << rejects.points << ", box " << rejects.boundingBox << ", area " << rejects.area
+              << ", convexity " << rejects.convexity << "), " << rejects.unclassified << " unclassified\n";
+    if (replayPath.empty())
+    {
+        std::cout << "Recall:      " << found << "/" << expected << " shapes found\n";
+    }
+    std::cout.flush();
+
+    if (Trace::isEnabled())
+    {
+        std::cout << '\n';
+        Trace::printSummary(std::cout);
+        if (!tracePath.empty())
+        {
+            Trace::exportChromeTrace(tracePath);
+        }
+    }
+    else if (!tracePath.empty())
+    {
+        std::cerr << "Warning: tracing is not compiled in, rebuild with make TRACE=1" << std::endl;
+    }
+
+    return 0;
+}
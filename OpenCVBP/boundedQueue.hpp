@@ -0,0 +1,161 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @class BoundedQueue
+ * @brief Fixed-capacity, lock-free multi-producer/multi-consumer queue.
+ *
+ * Every cell carries a sequence number that tells producers and consumers whether it is free
+ * or filled for the current lap, so pushing and popping only need a compare-and-swap on the
+ * shared position counter. Because any thread may pop, a producer can evict the oldest entry
+ * of a full queue itself, which is what the pipeline's drop-oldest policy relies on.
+ *
+ * @tparam T The element type; must be default constructible and move assignable.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    /**
+     * @brief Creates a queue holding at least the given number of elements.
+     *
+     * @param capacity Requested capacity, rounded up to the next power of two (minimum 2).
+     */
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief Appends an element if there is room.
+     *
+     * @param item The element to append; it is moved from only when the push succeeds.
+     * @return True if the element was appended, false if the queue is full.
+     */
+    bool tryPush(T &item)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+
+            if (difference == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.data = std::move(item);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest element if there is one.
+     *
+     * @param item Receives the removed element.
+     * @return True if an element was removed, false if the queue is empty.
+     */
+    bool tryPop(T &item)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+            if (difference == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    item = std::move(cell.data);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns an approximation of the number of queued elements.
+     *
+     * Only exact when no other thread is pushing or popping.
+     *
+     * @return The number of queued elements.
+     */
+    size_t size() const
+    {
+        size_t enqueued = enqueuePos.load(std::memory_order_acquire);
+        size_t dequeued = dequeuePos.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /** @return The number of elements the queue can hold. */
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    /** The ring of cells. */
+    std::unique_ptr<Cell[]> cells;
+
+    /** Capacity - 1, used to wrap positions onto cells. */
+    size_t mask = 0;
+
+    /** Position of the next push; kept on its own cache line to avoid false sharing. */
+    alignas(64) std::atomic<size_t> enqueuePos;
+
+    /** Position of the next pop; kept on its own cache line to avoid false sharing. */
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "colorStatistics.hpp"
+
+ColorStatistics::ColorStatistics()
+{
+}
+
+ColorStatistics::~ColorStatistics()
+{
+}
+
+void ColorStatistics::compute(const cv::Mat &image, const ContourList &contours, const std::vector<ContourFeatures> &features,
+                              std::vector<RegionColor> &colors)
+{
+    compute(image, contours, features, colors, cv::Range(0, static_cast<int>(contours.size())));
+}
+
+void ColorStatistics::compute(const cv::Mat &image, const ContourList &contours, const std::vector<ContourFeatures> &features,
+                              std::vector<RegionColor> &colors, const cv::Range &range)
+{
+    CV_Assert(image.type() == CV_8UC3);
+    colors.resize(contours.size());
+    std::fill(colors.begin() + range.start, colors.begin() + range.end, RegionColor());
+
+    if (labels.size() != image.size())
+    {
+        labels = cv::Mat::zeros(image.size(), CV_32SC1);
+    }
+
+    // The box of the approximated polygon in the features can miss parts of the filled contour, so
+    // gathering and clearing use the box of the very points that are filled.
+    cv::Rect frame(0, 0, image.cols, image.rows);
+    boxes.resize(contours.size());
+    for (int i = range.start; i < range.end; i++)
+    {
+        if (features[i].shapeClass != ShapeClass::None)
+        {
+            const cv::Point *points = contours[i].points;
+            int count = contours[i].size;
+            cv::fillPoly(labels, &points, &count, 1, cv::Scalar(static_cast<double>(i + 1)));
+            boxes[i] = cv::boundingRect(cv::Mat(count, 1, CV_32SC2, const_cast<cv::Point *>(points))) & frame;
+        }
+    }
+
+    cv::parallel_for_(range, [&](const cv::Range &stripe)
+                      {
+        for (int i = stripe.start; i < stripe.end; i++)
+        {
+            if (features[i].shapeClass != ShapeClass::None)
+            {
+                gather(image, boxes[i], i + 1, colors[i]);
+            }
+        } });
+
+    for (int i = range.start; i < range.end; i++)
+    {
+        if (features[i].shapeClass != ShapeClass::None)
+        {
+            labels(boxes[i]).setTo(cv::Scalar(0));
+        }
+    }
+}
+
+void ColorStatistics::gather(const cv::Mat &image, const cv::Rect &box, int label, RegionColor &color) const
+{
+    int histogram[3][256] = {};
+    double sum[3] = {0.0, 0.0, 0.0};
+    int pixels = 0;
+
+    for (int y = box.y; y < box.y + box.height; y++)
+    {
+        const int *labelRow = labels.ptr<int>(y);
+        const uchar *pixel = image.ptr<uchar>(y);
+        for (int x = box.x; x < box.x + box.width; x++)
+        {
+            if (labelRow[x] != label)
+            {
+                continue;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                uchar value = pixel[3 * x + c];
+                histogram[c][value]++;
+                sum[c] += value;
+            }
+            pixels++;
+        }
+    }
+
+    color.pixels = pixels;
+    if (pixels == 0)
+    {
+        return;
+    }
+
+    for (int c = 0; c < 3; c++)
+    {
+        color.mean[c] = sum[c] / pixels;
+
+        int cumulative = 0;
+        int value = 0;
+        while (value < 255 && (cumulative += histogram[c][value]) * 2 < pixels)
+        {
+            value++;
+        }
+        color.median[c] = static_cast<uchar>(value);
+    }
+}
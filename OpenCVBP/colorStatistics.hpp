@@ -0,0 +1,88 @@
+#ifndef COLORSTATISTICS_H
+#define COLORSTATISTICS_H
+
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+#include "shapeClassifier.hpp"
+#include "contourList.hpp"
+
+/**
+ * @struct RegionColor
+ * @brief Color statistics of the pixels inside one contour.
+ */
+struct RegionColor
+{
+    /** Mean BGR color. */
+    cv::Scalar mean;
+
+    /** Per-channel median BGR color; robust against edge pixels, highlights and holes. */
+    cv::Vec3b median;
+
+    /** Number of pixels inside the contour. */
+    int pixels = 0;
+};
+
+/**
+ * @class ColorStatistics
+ * @brief Computes the color of the actual interior of every contour of a frame in one shared pass.
+ *
+ * Sampling a patch at the centroid gives wrong colors for half circles and hollow shapes, whose
+ * centroid can lie off the shape. Instead, all contours are rasterized once into a shared label
+ * image (contour i is filled with i + 1), and the statistics of every contour are gathered from
+ * the pixels of its bounding box that carry its label. Contours are processed in parallel, every
+ * pixel is touched only by the contours whose bounding box covers it, and the label image is
+ * cleared box by box afterwards, so no full-frame pass is made per frame or per shape.
+ */
+class ColorStatistics
+{
+public:
+    ColorStatistics();
+    virtual ~ColorStatistics();
+
+    /**
+     * @brief Computes the color statistics of every classified contour.
+     *
+     * @param image The 8-bit BGR frame the contours were found in.
+     * @param contours The contours, in frame coordinates.
+     * @param features The features of every contour; contours with ShapeClass::None are skipped.
+     * @param colors Receives one entry per contour; skipped contours get zero pixels.
+     */
+    void compute(const cv::Mat &image, const ContourList &contours, const std::vector<ContourFeatures> &features,
+                 std::vector<RegionColor> &colors);
+
+    /**
+     * @brief Computes the color statistics of the classified contours in a range of indices.
+     *
+     * Entries outside the range are left as they are, so the contours of a frame can be measured
+     * in consecutive batches.
+     *
+     * @param image The 8-bit BGR frame the contours were found in.
+     * @param contours The contours, in frame coordinates.
+     * @param features The features of every contour; contours with ShapeClass::None are skipped.
+     * @param colors Grown to one entry per contour; entries in the range are replaced.
+     * @param range The indices of the contours to measure.
+     */
+    void compute(const cv::Mat &image, const ContourList &contours, const std::vector<ContourFeatures> &features,
+                 std::vector<RegionColor> &colors, const cv::Range &range);
+
+private:
+    /**
+     * @brief Gathers the statistics of one contour from its labelled pixels.
+     *
+     * @param image The 8-bit BGR frame.
+     * @param box The bounding box of the contour, clipped to the frame.
+     * @param label The label the contour was rasterized with.
+     * @param color Receives the statistics.
+     */
+    void gather(const cv::Mat &image, const cv::Rect &box, int label, RegionColor &color) const;
+
+    /** Contour label per pixel, zero outside the contours being processed. */
+    cv::Mat labels;
+
+    /** Bounding box of every filled contour, clipped to the frame. */
+    std::vector<cv::Rect> boxes;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "colorTable.hpp"
+
+namespace
+{
+const std::string unknownColor = "Unknown";
+
+bool equalsLowercase(std::string_view name, const std::string &lowercase)
+{
+    if (name.size() != lowercase.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        if (std::tolower(static_cast<unsigned char>(name[i])) != lowercase[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readBound(const cv::FileNode &node, cv::Vec3b &bound)
+{
+    if (!node.isSeq() || node.size() != 3)
+    {
+        return false;
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        bound[c] = cv::saturate_cast<uchar>(static_cast<int>(node[c]));
+    }
+    return true;
+}
+}
+
+ColorTable::ColorTable()
+{
+    // The thresholds of the original hand-written classifier, limited to the saturation and value
+    // range of the original preprocessing mask.
+    setClasses({{"roze", {"pink"}, cv::Vec3b(108, 100, 44), cv::Vec3b(170, 255, 255)},
+                {"oranje", {"orange"}, cv::Vec3b(95, 14, 44), cv::Vec3b(179, 42, 255)},
+                {"groen", {"green"}, cv::Vec3b(38, 45, 44), cv::Vec3b(110, 255, 255)},
+                {"geel", {"yellow"}, cv::Vec3b(15, 14, 44), cv::Vec3b(100, 255, 255)}});
+}
+
+ColorTable::~ColorTable()
+{
+}
+
+bool ColorTable::load(const std::string &path)
+{
+    cv::FileStorage file;
+    try
+    {
+        file.open(path, cv::FileStorage::READ);
+    }
+    catch (const cv::Exception &exception)
+    {
+        std::cerr << "Error: Could not parse color configuration " << path << ": " << exception.what() << std::endl;
+        return false;
+    }
+    if (!file.isOpened())
+    {
+        std::cerr << "Error: Could not open color configuration " << path << std::endl;
+        return false;
+    }
+
+    cv::FileNode colors = file["colors"];
+    if (!colors.isSeq() || colors.size() == 0 || colors.size() > 255)
+    {
+        std::cerr << "Error: " << path << " needs a 'colors' list of 1 to 255 entries" << std::endl;
+        return false;
+    }
+
+    std::vector<ColorClass> loaded;
+    for (size_t i = 0; i < colors.size(); i++)
+    {
+        cv::FileNode node = colors[static_cast<int>(i)];
+        ColorClass color;
+        color.name = static_cast<std::string>(node["name"]);
+        if (color.name.empty() || !readBound(node["lower"], color.lower) || !readBound(node["upper"], color.upper))
+        {
+            std::cerr << "Error: color " << i << " in " << path << " needs a name and [h, s, v] lower and upper bounds" << std::endl;
+            return false;
+        }
+        std::transform(color.name.begin(), color.name.end(), color.name.begin(), ::tolower);
+
+        cv::FileNode aliases = node["aliases"];
+        for (size_t a = 0; aliases.isSeq() && a < aliases.size(); a++)
+        {
+            std::string alias = static_cast<std::string>(aliases[static_cast<int>(a)]);
+            std::transform(alias.begin(), alias.end(), alias.begin(), ::tolower);
+            color.aliases.push_back(alias);
+        }
+        loaded.push_back(color);
+    }
+
+    setClasses(loaded);
+    return true;
+}
+
+void ColorTable::setClasses(const std::vector<ColorClass> &classes)
+{
+    this->classes.assign(classes.begin(), classes.begin() + std::min<size_t>(classes.size(), 255));
+    compile();
+}
+
+const std::vector<ColorClass> &ColorTable::getClasses() const
+{
+    return classes;
+}
+
+uchar ColorTable::find(std::string_view name) const
+{
+    for (size_t i = 0; i < classes.size(); i++)
+    {
+        if (equalsLowercase(name, classes[i].name))
+        {
+            return static_cast<uchar>(i + 1);
+        }
+        for (const std::string &alias : classes[i].aliases)
+        {
+            if (equalsLowercase(name, alias))
+            {
+                return static_cast<uchar>(i + 1);
+            }
+        }
+    }
+    return none;
+}
+
+const std::string &ColorTable::getName(uchar id) const
+{
+    return id == none || id > classes.size() ? unknownColor : classes[id - 1].name;
+}
+
+ColorTable &ColorTable::shared()
+{
+    static ColorTable table;
+    return table;
+}
+
+void ColorTable::compile()
+{
+    const int levels = 1 << bits;
+    const int half = 1 << (7 - bits);
+
+    // Convert the center of every BGR bin to HSV in one call, then classify the bins.
+    cv::Mat bgr(1, levels * levels * levels, CV_8UC3);
+    for (int b = 0; b < levels; b++)
+    {
+        for (int g = 0; g < levels; g++)
+        {
+            for (int r = 0; r < levels; r++)
+            {
+                bgr.at<cv::Vec3b>(0, (b * levels + g) * levels + r) = cv::Vec3b((b << (8 - bits)) + half, (g << (8 - bits)) + half, (r << (8 - bits)) + half);
+            }
+        }
+    }
+
+    cv::Mat hsv;
+    cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+
+    table.assign(bgr.cols, none);
+    for (int i = 0; i < hsv.cols; i++)
+    {
+        const cv::Vec3b &pixel = hsv.at<cv::Vec3b>(0, i);
+        for (size_t c = 0; c < classes.size(); c++)
+        {
+            const ColorClass &color = classes[c];
+            if (pixel[0] >= color.lower[0] && pixel[0] <= color.upper[0] &&
+                pixel[1] >= color.lower[1] && pixel[1] <= color.upper[1] &&
+                pixel[2] >= color.lower[2] && pixel[2] <= color.upper[2])
+            {
+                table[i] = static_cast<uchar>(c + 1);
+                break;
+            }
+        }
+    }
+}
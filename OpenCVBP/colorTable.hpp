@@ -0,0 +1,143 @@
+#ifndef COLORTABLE_H
+#define COLORTABLE_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct ColorClass
+ * @brief A named color, defined as an inclusive HSV box (hue 0-179, saturation and value 0-255).
+ */
+struct ColorClass
+{
+    /** Lowercase name of the color, e.g. "geel". */
+    std::string name;
+
+    /** Other lowercase names the color can be asked for by, e.g. "yellow". */
+    std::vector<std::string> aliases;
+
+    /** Inclusive lower bound as (hue, saturation, value). */
+    cv::Vec3b lower;
+
+    /** Inclusive upper bound as (hue, saturation, value). */
+    cv::Vec3b upper;
+};
+
+/**
+ * @class ColorTable
+ * @brief Classifies BGR pixels into the configured color classes with a single table read.
+ *
+ * The color classes are the one source of truth for both the preprocessing mask (a pixel
+ * survives when it belongs to any class) and the color of a shape. They are loaded from a
+ * YAML or JSON file, so new colors need no recompile:
+ *
+ *     %YAML:1.0
+ *     colors:
+ *        - { name: roze, aliases: [pink], lower: [108, 100, 44], upper: [170, 255, 255] }
+ *        - { name: geel, lower: [15, 14, 44], upper: [100, 255, 255] }
+ *
+ * Shapes and queries refer to a class by its ID; names and aliases are only used to read
+ * commands and write results.
+ * Classes are tried in file order and the first match wins. They are compiled into a lookup
+ * table indexed by the BGR value quantized to 5 bits per channel (32768 one-byte entries, small
+ * enough to stay cache resident); every entry holds the class of the center of its BGR bin.
+ */
+class ColorTable
+{
+public:
+    /** Class ID of pixels that belong to no color class. */
+    static const uchar none = 0;
+
+    /**
+     * @brief Creates a table with the built-in color classes (roze, oranje, groen, geel), with
+     *        their English names as aliases.
+     */
+    ColorTable();
+    virtual ~ColorTable();
+
+    /**
+     * @brief Replaces the color classes by the ones in a YAML or JSON file.
+     *
+     * @param path The color configuration file.
+     * @return True if the file was read; on failure the current classes are kept.
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Replaces the color classes and recompiles the lookup table.
+     *
+     * @param classes At most 255 classes, in order of precedence.
+     */
+    void setClasses(const std::vector<ColorClass> &classes);
+
+    /** @return The color classes in order of precedence; class ID i + 1 is classes[i]. */
+    const std::vector<ColorClass> &getClasses() const;
+
+    /**
+     * @brief Looks up a color class by name or alias, case-insensitively.
+     *
+     * @param name Name of the color.
+     * @return The class ID, or ColorTable::none if there is no such color.
+     */
+    uchar find(std::string_view name) const;
+
+    /**
+     * @brief Returns the name of a class ID.
+     *
+     * @param id A class ID.
+     * @return The name of the class, "Unknown" for ColorTable::none or an invalid ID.
+     */
+    const std::string &getName(uchar id) const;
+
+    /**
+     * @brief Classifies one BGR pixel.
+     *
+     * @return The class ID of the pixel, ColorTable::none if it belongs to no class.
+     */
+    uchar classify(uchar b, uchar g, uchar r) const
+    {
+        return table[index(b, g, r)];
+    }
+
+    /** @return The lookup table, indexed by index(). */
+    const uchar *data() const
+    {
+        return table.data();
+    }
+
+    /** @return The table index of a BGR pixel. */
+    static int index(uchar b, uchar g, uchar r)
+    {
+        return ((b >> (8 - bits)) << (2 * bits)) | ((g >> (8 - bits)) << bits) | (r >> (8 - bits));
+    }
+
+    /**
+     * @brief Returns the process-wide table used by the detector.
+     *
+     * Load the configuration into it before detection starts; it is read concurrently afterwards.
+     *
+     * @return The shared table.
+     */
+    static ColorTable &shared();
+
+private:
+    /**
+     * @brief Fills the lookup table from the color classes.
+     */
+    void compile();
+
+    /** Bits per channel of the quantized BGR index. */
+    static const int bits = 5;
+
+    /** The color classes in order of precedence. */
+    std::vector<ColorClass> classes;
+
+    /** Class ID per quantized BGR value. */
+    std::vector<uchar> table;
+};
+
+#endif
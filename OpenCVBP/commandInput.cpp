@@ -0,0 +1,159 @@
+#include "commandInput.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+CommandInput::CommandInput()
+{
+}
+
+CommandInput::~CommandInput()
+{
+    close();
+}
+
+bool CommandInput::listen(const std::string &path)
+{
+    close();
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Error: Invalid control socket path " << path << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not create control socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(fd, 4) != 0)
+    {
+        std::cerr << "Error: Could not listen on control socket " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    listenFd = fd;
+    socketPath = path;
+    return true;
+}
+
+void CommandInput::run(const std::atomic<bool> &running, const std::function<void(const std::string &)> &handle)
+{
+    std::vector<Connection> connections(1);
+    connections[0].fd = STDIN_FILENO;
+    std::vector<pollfd> fds;
+
+    while (running.load() && (!connections.empty() || listenFd >= 0))
+    {
+        fds.clear();
+        for (const Connection &connection : connections)
+        {
+            fds.push_back(pollfd{connection.fd, POLLIN, 0});
+        }
+        if (listenFd >= 0)
+        {
+            fds.push_back(pollfd{listenFd, POLLIN, 0});
+        }
+
+        int ready = ::poll(fds.data(), fds.size(), pollMilliseconds);
+        if (ready < 0 && errno != EINTR)
+        {
+            std::cerr << "Error: Waiting for commands failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (ready <= 0)
+        {
+            continue;
+        }
+
+        // Connections are only added and removed after every polled descriptor has been served.
+        size_t polled = connections.size();
+        std::vector<Connection> kept;
+        for (size_t i = 0; i < polled; i++)
+        {
+            if (fds[i].revents == 0 || receive(connections[i], handle))
+            {
+                kept.push_back(std::move(connections[i]));
+            }
+            else if (connections[i].fd != STDIN_FILENO)
+            {
+                ::close(connections[i].fd);
+            }
+        }
+        connections = std::move(kept);
+
+        if (listenFd >= 0 && (fds[polled].revents & POLLIN))
+        {
+            int client = ::accept(listenFd, nullptr, nullptr);
+            if (client >= 0)
+            {
+                Connection connection;
+                connection.fd = client;
+                connections.push_back(std::move(connection));
+            }
+        }
+    }
+
+    for (const Connection &connection : connections)
+    {
+        if (connection.fd != STDIN_FILENO)
+        {
+            ::close(connection.fd);
+        }
+    }
+}
+
+bool CommandInput::receive(Connection &connection, const std::function<void(const std::string &)> &handle)
+{
+    char buffer[4096];
+    ssize_t count = ::read(connection.fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR)
+    {
+        return true;
+    }
+    if (count <= 0)
+    {
+        return false;
+    }
+
+    connection.pending.append(buffer, static_cast<size_t>(count));
+
+    size_t begin = 0;
+    size_t end;
+    while ((end = connection.pending.find('\n', begin)) != std::string::npos)
+    {
+        size_t length = end - begin;
+        if (length > 0 && connection.pending[end - 1] == '\r')
+        {
+            length--;
+        }
+        handle(connection.pending.substr(begin, length));
+        begin = end + 1;
+    }
+    connection.pending.erase(0, begin);
+    return true;
+}
+
+void CommandInput::close()
+{
+    if (listenFd >= 0)
+    {
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+    listenFd = -1;
+    socketPath.clear();
+}
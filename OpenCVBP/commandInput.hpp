@@ -0,0 +1,79 @@
+#ifndef COMMANDINPUT_H
+#define COMMANDINPUT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+
+/**
+ * @class CommandInput
+ * @brief Reads text commands, one per line, from stdin and optionally from a control socket.
+ *
+ * All inputs are waited on with poll() and a short timeout instead of a blocking read, so the
+ * reading thread notices within a fraction of a second when the program is asked to end from
+ * elsewhere, e.g. by a key press in the window. The control socket is a Unix domain stream
+ * socket; every connected client sends commands in the same form as typed on stdin, e.g.
+ * `echo "Cirkel Groen" | nc -U /tmp/shapedetector.sock`.
+ */
+class CommandInput
+{
+public:
+    CommandInput();
+    virtual ~CommandInput();
+
+    CommandInput(const CommandInput &) = delete;
+    CommandInput &operator=(const CommandInput &) = delete;
+
+    /**
+     * @brief Creates a control socket that accepts commands next to stdin.
+     *
+     * @param path File system path of the socket; an existing file at the path is replaced.
+     * @return True if the socket is listening.
+     */
+    bool listen(const std::string &path);
+
+    /**
+     * @brief Passes every complete line to a handler until `running` is cleared or all inputs are closed.
+     *
+     * @param running Checked at least every pollMilliseconds; the handler may clear it.
+     * @param handle Called with each line, without the line end, on the calling thread.
+     */
+    void run(const std::atomic<bool> &running, const std::function<void(const std::string &)> &handle);
+
+private:
+    /**
+     * @struct Connection
+     * @brief An input with the bytes received after its last complete line.
+     */
+    struct Connection
+    {
+        /** The file descriptor; 0 for stdin. */
+        int fd = -1;
+
+        /** Received bytes not yet ending in a line end. */
+        std::string pending;
+    };
+
+    /**
+     * @brief Reads what is available on a connection and handles the complete lines.
+     *
+     * @return False if the connection was closed by the other side or failed.
+     */
+    bool receive(Connection &connection, const std::function<void(const std::string &)> &handle);
+
+    /** Closes the control socket and removes its file. */
+    void close();
+
+    /** Path of the control socket, empty without one. */
+    std::string socketPath;
+
+    /** Listening control socket, -1 without one. */
+    int listenFd = -1;
+
+    /** Longest time an input wait blocks before `running` is checked again. */
+    static constexpr int pollMilliseconds = 100;
+};
+
+#endif
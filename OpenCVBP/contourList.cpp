@@ -0,0 +1,42 @@
+#include "contourList.hpp"
+
+#include <cstring>
+
+ContourList::ContourList()
+{
+}
+
+ContourList::~ContourList()
+{
+}
+
+void ContourList::clear()
+{
+    contours.clear();
+}
+
+void ContourList::add(const std::vector<cv::Point> &contour, FrameArena &arena)
+{
+    cv::Point *points = arena.allocate<cv::Point>(contour.size());
+    std::memcpy(static_cast<void *>(points), contour.data(), contour.size() * sizeof(cv::Point));
+
+    Contour view;
+    view.points = points;
+    view.size = static_cast<int>(contour.size());
+    contours.push_back(view);
+}
+
+size_t ContourList::size() const
+{
+    return contours.size();
+}
+
+bool ContourList::empty() const
+{
+    return contours.empty();
+}
+
+const Contour &ContourList::operator[](size_t index) const
+{
+    return contours[index];
+}
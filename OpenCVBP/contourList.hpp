@@ -0,0 +1,75 @@
+#ifndef CONTOURLIST_H
+#define CONTOURLIST_H
+
+#include <iostream>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include "frameArena.hpp"
+
+/**
+ * @struct Contour
+ * @brief A view of the points of one contour.
+ */
+struct Contour
+{
+    /** The points, in order along the contour. */
+    const cv::Point *points = nullptr;
+
+    /** Number of points. */
+    int size = 0;
+
+    /**
+     * @brief Wraps the points in a Nx1 CV_32SC2 matrix header without copying, for OpenCV functions.
+     *
+     * @return The matrix header.
+     */
+    cv::Mat mat() const
+    {
+        return cv::Mat(size, 1, CV_32SC2, const_cast<cv::Point *>(points));
+    }
+};
+
+/**
+ * @class ContourList
+ * @brief The contours of one frame, with all points stored in a FrameArena.
+ *
+ * cv::findContours produces one std::vector per contour; keeping those across frames means one
+ * heap allocation per contour per frame. Instead, the points of every found contour are copied
+ * into the frame's arena and only a view per contour is kept, so the whole list is released by
+ * resetting the arena.
+ */
+class ContourList
+{
+public:
+    ContourList();
+    virtual ~ContourList();
+
+    /**
+     * @brief Removes all contours. Call before resetting the arena the points came from.
+     */
+    void clear();
+
+    /**
+     * @brief Copies a contour into the arena and appends it.
+     *
+     * @param contour The points of the contour.
+     * @param arena The arena that holds the points until the next reset.
+     */
+    void add(const std::vector<cv::Point> &contour, FrameArena &arena);
+
+    /** @return The number of contours. */
+    size_t size() const;
+
+    /** @return True if the list has no contours. */
+    bool empty() const;
+
+    /** @return The contour at an index. */
+    const Contour &operator[](size_t index) const;
+
+private:
+    /** Views of the contours. */
+    std::vector<Contour> contours;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "detectionStore.hpp"
+
+DetectionStore::DetectionStore()
+{
+}
+
+DetectionStore::~DetectionStore()
+{
+}
+
+void DetectionStore::clear()
+{
+    contours.clear();
+    shapeClasses.clear();
+    colors.clear();
+    centroids.clear();
+    boundingBoxes.clear();
+    areas.clear();
+    confidences.clear();
+    clocktickBegins.clear();
+    clocktickEnds.clear();
+    trackIds.clear();
+    matchedFlags.clear();
+}
+
+size_t DetectionStore::add(int contour, ShapeClass shapeClass, const cv::Point &centroid, const cv::Rect &boundingBox, double area,
+                           double confidence, int64_t clocktickBegin, int64_t clocktickEnd)
+{
+    contours.push_back(contour);
+    shapeClasses.push_back(shapeClass);
+    colors.push_back(ColorTable::none);
+    centroids.push_back(centroid);
+    boundingBoxes.push_back(boundingBox);
+    areas.push_back(area);
+    confidences.push_back(confidence);
+    clocktickBegins.push_back(clocktickBegin);
+    clocktickEnds.push_back(clocktickEnd);
+    trackIds.push_back(-1);
+    matchedFlags.push_back(0);
+    return contours.size() - 1;
+}
+
+size_t DetectionStore::size() const
+{
+    return contours.size();
+}
+
+bool DetectionStore::empty() const
+{
+    return contours.empty();
+}
+
+DetectionStore::Selection DetectionStore::select(ShapeClass shapeClass, uchar color) const
+{
+    return Selection(*this, shapeClass, color, false);
+}
+
+DetectionStore::Selection DetectionStore::matched() const
+{
+    return Selection(*this, ShapeClass::None, none, true);
+}
+
+int DetectionStore::getContour(size_t index) const
+{
+    return contours[index];
+}
+
+ShapeClass DetectionStore::getShapeClass(size_t index) const
+{
+    return shapeClasses[index];
+}
+
+uchar DetectionStore::getColor(size_t index) const
+{
+    return colors[index];
+}
+
+const cv::Point &DetectionStore::getCentroid(size_t index) const
+{
+    return centroids[index];
+}
+
+const cv::Rect &DetectionStore::getBoundingBox(size_t index) const
+{
+    return boundingBoxes[index];
+}
+
+double DetectionStore::getArea(size_t index) const
+{
+    return areas[index];
+}
+
+double DetectionStore::getConfidence(size_t index) const
+{
+    return confidences[index];
+}
+
+int64_t DetectionStore::getClocktickBegin(size_t index) const
+{
+    return clocktickBegins[index];
+}
+
+int64_t DetectionStore::getClocktickEnd(size_t index) const
+{
+    return clocktickEnds[index];
+}
+
+int DetectionStore::getTrackId(size_t index) const
+{
+    return trackIds[index];
+}
+
+bool DetectionStore::isMatched(size_t index) const
+{
+    return matchedFlags[index] != 0;
+}
+
+void DetectionStore::setColor(size_t index, uchar color)
+{
+    colors[index] = color;
+}
+
+void DetectionStore::setTrackId(size_t index, int trackId)
+{
+    trackIds[index] = trackId;
+}
+
+void DetectionStore::setMatched(size_t index, bool matched)
+{
+    matchedFlags[index] = matched ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+#ifndef DETECTIONSTORE_H
+#define DETECTIONSTORE_H
+
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+#include "colorTable.hpp"
+#include "shapeClassifier.hpp"
+
+/**
+ * @class DetectionStore
+ * @brief The shapes classified in one frame, stored as one contiguous array per attribute.
+ *
+ * Every contour that was labelled with a shape class gets one entry; contours that matched no
+ * shape are not stored. Consumers that look at one or two attributes of every shape, such as the
+ * query matcher (class and color) or the tracker (class, color and box), scan only the arrays
+ * they need. The arrays keep their capacity when the store is cleared, so once a stream has
+ * reached its usual shape count, filling the store allocates nothing.
+ *
+ * Entries are addressed by index; select() and matched() iterate over the indices of the
+ * entries that pass a filter:
+ *
+ *     for (size_t i : store.select(ShapeClass::Circle, store.none))
+ *         draw(store.getCentroid(i));
+ */
+class DetectionStore
+{
+public:
+    /**
+     * @class Selection
+     * @brief A lazily filtered range over the indices of a DetectionStore.
+     */
+    class Selection
+    {
+    public:
+        /**
+         * @class iterator
+         * @brief Forward iterator yielding the index of every entry that passes the filter.
+         */
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const size_t *;
+            using reference = size_t;
+
+            iterator(const Selection &selection, size_t index)
+                : selection(&selection),
+                  index(index)
+            {
+                skip();
+            }
+
+            size_t operator*() const
+            {
+                return index;
+            }
+
+            iterator &operator++()
+            {
+                index++;
+                skip();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const iterator &other) const
+            {
+                return index == other.index;
+            }
+
+            bool operator!=(const iterator &other) const
+            {
+                return index != other.index;
+            }
+
+        private:
+            /** Advances to the next entry that passes the filter, or to the end. */
+            void skip()
+            {
+                while (index < selection->store->size() && !selection->accepts(index))
+                {
+                    index++;
+                }
+            }
+
+            const Selection *selection;
+            size_t index;
+        };
+
+        Selection(const DetectionStore &store, ShapeClass shapeClass, uchar color, bool matchedOnly)
+            : store(&store),
+              shapeClass(shapeClass),
+              color(color),
+              matchedOnly(matchedOnly)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(*this, 0);
+        }
+
+        iterator end() const
+        {
+            return iterator(*this, store->size());
+        }
+
+        /** @return True if the entry passes the filter. */
+        bool accepts(size_t index) const
+        {
+            return (shapeClass == ShapeClass::None || store->shapeClasses[index] == shapeClass) &&
+                   (color == ColorTable::none || store->colors[index] == color) &&
+                   (!matchedOnly || store->matchedFlags[index]);
+        }
+
+    private:
+        const DetectionStore *store;
+        ShapeClass shapeClass;
+        uchar color;
+        bool matchedOnly;
+    };
+
+    /** Wildcard color for select(). */
+    static const uchar none = ColorTable::none;
+
+    DetectionStore();
+    virtual ~DetectionStore();
+
+    /**
+     * @brief Removes all entries, keeping the capacity of the arrays.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a classified shape without a color.
+     *
+     * @param contour Index of the shape's contour in the frame.
+     * @param shapeClass The shape class.
+     * @param centroid Center of the shape.
+     * @param boundingBox Bounding box of the shape.
+     * @param area Area enclosed by the contour.
+     * @param confidence Confidence of the shape class (see ContourFeatures::confidence).
+     * @param clocktickBegin Tick count (cv::getTickCount) when classifying the shape began.
+     * @param clocktickEnd Tick count when the geometric classification ended.
+     * @return The index of the new entry.
+     */
+    size_t add(int contour, ShapeClass shapeClass, const cv::Point &centroid, const cv::Rect &boundingBox, double area,
+               double confidence, int64_t clocktickBegin, int64_t clocktickEnd);
+
+    /** @return The number of entries. */
+    size_t size() const;
+
+    /** @return True if the store has no entries. */
+    bool empty() const;
+
+    /**
+     * @brief Returns the entries of a shape class and color.
+     *
+     * @param shapeClass The shape class, ShapeClass::None for any.
+     * @param color The color class ID, DetectionStore::none for any.
+     * @return The range of matching indices.
+     */
+    Selection select(ShapeClass shapeClass, uchar color) const;
+
+    /** @return The entries that answered a query (see setMatched()). */
+    Selection matched() const;
+
+    int getContour(size_t index) const;
+    ShapeClass getShapeClass(size_t index) const;
+    uchar getColor(size_t index) const;
+    const cv::Point &getCentroid(size_t index) const;
+    const cv::Rect &getBoundingBox(size_t index) const;
+    double getArea(size_t index) const;
+    double getConfidence(size_t index) const;
+    int64_t getClocktickBegin(size_t index) const;
+    int64_t getClocktickEnd(size_t index) const;
+    int getTrackId(size_t index) const;
+    bool isMatched(size_t index) const;
+
+    void setColor(size_t index, uchar color);
+    void setTrackId(size_t index, int trackId);
+    void setMatched(size_t index, bool matched);
+
+private:
+    /** Index of the contour of every entry. */
+    std::vector<int> contours;
+
+    /** Shape class of every entry. */
+    std::vector<ShapeClass> shapeClasses;
+
+    /** Color class ID of every entry, ColorTable::none until measured. */
+    std::vector<uchar> colors;
+
+    /** Center of every entry. */
+    std::vector<cv::Point> centroids;
+
+    /** Bounding box of every entry. */
+    std::vector<cv::Rect> boundingBoxes;
+
+    /** Enclosed area of every entry. */
+    std::vector<double> areas;
+
+    /** Confidence of the shape class of every entry. */
+    std::vector<double> confidences;
+
+    /** Tick count when classifying every entry began. */
+    std::vector<int64_t> clocktickBegins;
+
+    /** Tick count when the geometric classification of every entry ended. */
+    std::vector<int64_t> clocktickEnds;
+
+    /** Track ID of every entry, -1 if it answered no query. */
+    std::vector<int> trackIds;
+
+    /** Whether every entry answered a query; bytes rather than std::vector<bool> bits for cheap access. */
+    std::vector<uchar> matchedFlags;
+};
+
+#endif
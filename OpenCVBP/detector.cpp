@@ -1,443 +1,842 @@
 #include "detector.hpp"
+#include "pipeline.hpp"
 
 Detector::Detector(){};
 
 Detector::~Detector(){};
 
-void Detector::detectShapes(cv::Mat image)
+void Detector::detectShapes(cv::Mat &image)
 {
+    activeQueries.assign(1, Query{shape, color});
+    detectShapes(image, activeQueries);
+}
+
+void Detector::detectShapes(cv::Mat &image, const std::vector<Query> &queries)
+{
+    TRACE_SCOPE("detectShapes");
+    unsigned long long allocationsBegin = AllocationCounter::getCount();
+    int64 frameBegin = cv::getTickCount();
     this->inputImage = image;
 
+    drawList.clear();
+    chooseSearchRect();
     preProcessImage();
 
-    if (shape == "driehoek")
-    {
-        detectTriangle(color);
-    }
-    else if (shape == "vierkant")
-    {
-        detectSquare(color);
-    }
-    else if (shape == "rechthoek")
-    {
-        detectRectangle(color);
-    }
-    else if (shape == "cirkel")
-    {
-        detectCircle(color);
-    }
-    else if (shape == "halve cirkel")
-    {
-        detectHalfCircle(color);
-    }
+    int64 classifyBegin = cv::getTickCount();
+    classifyContours(queries);
+    int64 queriesBegin = cv::getTickCount();
+    frameTimings.classify = (queriesBegin - classifyBegin) / cv::getTickFrequency();
 
-    if (!foundShape)
+    int missLine = 0;
+    frameMisses = 0;
+    for (const Query &query : queries)
     {
-        if (batchMode)
+        TRACE_SCOPE("query");
+        foundShape = false;
+        if (answerQuery(query))
         {
-            std::cout << "No " << shape << " with color " << color << " found"
-                      << " - Time: " << (cv::getCPUTickCount() - shapesVector[0].getShapeClocktickBegin()) / cv::getTickFrequency() << " s" << std::endl;
+            continue;
         }
-        else
+        trackingMiss = true;
+        frameMisses++;
+
+        double time = (cv::getTickCount() - frameClocktickBegin) / cv::getTickFrequency();
+        if (resultSink)
+        {
+            record.found = false;
+            record.trackId = -1;
+            record.shape = ShapeClassifier::getShapeClassKey(query.shape);
+            record.color = colorTable->getName(query.color);
+            record.centroid = cv::Point();
+            record.boundingBox = cv::Rect();
+            record.area = 0.0;
+            record.confidence = 0.0;
+            record.shapeTime = 0.0;
+            record.frameTime = time;
+            resultSink->write(record);
+        }
+        if (!batchMode && annotate)
         {
-            std::string formattedLabel = "No " + shape + " with color " + color + " found" + " - Time: " + std::to_string((cv::getCPUTickCount() - shapesVector[0].getShapeClocktickBegin()) / cv::getTickFrequency()) + " s";
-            cv::putText(inputImage, formattedLabel, cv::Point(10, 70), cv::FONT_HERSHEY_SIMPLEX, 2, cv::Scalar(0, 0, 255), 1);
+            labelText.assign("No ");
+            labelText += ShapeClassifier::getShapeClassKey(query.shape);
+            labelText += " with color ";
+            labelText += colorTable->getName(query.color);
+            labelText += " found - Time: ";
+            labelText += std::to_string(time);
+            labelText += " s";
+            drawList.addText(cv::Point(10, 70 + 60 * missLine++), labelText, cv::Scalar(0, 0, 255), 2);
         }
     }
+
+    updateTracks();
+
+    // Everything drawn from the arena during this frame is released at once.
+    arenaStats = frameArena.getStats();
+    contours.clear();
+    frameArena.reset();
+
+    int64 frameEnd = cv::getTickCount();
+    frameTimings.queries = (frameEnd - queriesBegin) / cv::getTickFrequency();
+    frameTimings.total = (frameEnd - frameBegin) / cv::getTickFrequency();
+    frameAllocations = AllocationCounter::getCount() - allocationsBegin;
+    Trace::tick();
+}
+
+unsigned long long Detector::getFrameAllocations() const
+{
+    return frameAllocations;
+}
+
+unsigned Detector::getFrameMisses() const
+{
+    return frameMisses;
+}
+
+const ArenaStats &Detector::getArenaStats() const
+{
+    return arenaStats;
+}
+
+const RejectStats &Detector::getRejectStats() const
+{
+    return rejectStats;
+}
+
+const FrameTimings &Detector::getFrameTimings() const
+{
+    return frameTimings;
+}
+
+const DetectionStore &Detector::getDetections() const
+{
+    return detections;
+}
+
+void Detector::setAnnotate(bool annotate)
+{
+    this->annotate = annotate;
+}
+
+const DrawList &Detector::getDrawList() const
+{
+    return drawList;
+}
+
+void Detector::swapDrawList(DrawList &list)
+{
+    std::swap(drawList, list);
+}
+
+void Detector::setResultSink(ResultSink *sink)
+{
+    resultSink = sink;
+}
+
+void Detector::setFrameOrigin(const std::string &source, long long frame)
+{
+    record.source = source;
+    record.frame = frame;
+}
+
+void Detector::setTracking(const TrackingConfig &config)
+{
+    trackingConfig = config;
+    tracks.clear();
+    framesSinceFullSearch = 0;
+    trackingMiss = false;
+}
+
+void Detector::setSegmentation(Segmentation segmentation)
+{
+    this->segmentation = segmentation;
+}
+
+void Detector::setPyramidLevels(int levels)
+{
+    pyramidLevels = std::max(0, std::min(levels, 4));
+}
+
+void Detector::setCannyThresholds(const CannyThresholds &thresholds)
+{
+    cannyThresholds = thresholds;
+}
+
+void Detector::setColorTable(const ColorTable &table)
+{
+    colorTable = &table;
+    preprocessor.setColorTable(table);
+}
+
+const cv::Rect &Detector::getSearchRect() const
+{
+    return searchRect;
 }
 
 void Detector::InteractiveMode()
 {
+    InteractiveMode("", PipelineConfig());
+}
 
-    cv::VideoCapture capture(0, cv::CAP_ANY);
-    if (!capture.isOpened())
+void Detector::InteractiveMode(const std::string &location, const PipelineConfig &config)
+{
+    FrameSource source;
+    if (!source.open(location))
     {
-        std::cerr << "Error: Could not open camera" << std::endl;
         return;
     }
 
+    inputThreadRunning = true;
     std::thread inputThread([this]
                             { this->inputThread(); });
 
-    cv::Mat frame;
-    inputThreadRunning = true;
-
     std::cout << "Enter 'shape color' (e.g., 'Cirkel Groen'), 'stop' to stop detection, or 'exit' to quit:" << std::endl;
 
-    while (inputThreadRunning.load())
-    {
-        capture >> frame;
-        if (frame.empty())
-        {
-            std::cerr << "Failed to capture image from webcam." << std::endl;
-            break;
-        }
+    Pipeline pipeline(config);
+    pipeline.run(source, *this);
 
-        foundShape = false;
+    const PipelineStats &stats = pipeline.getStats();
+    std::cout << "Frames captured: " << stats.captured << " - detected: " << stats.detected
+              << " - rendered: " << stats.rendered << " - dropped: " << stats.dropped << std::endl;
 
-        if (inputThreadDetect.load())
-        {
-            detectShapes(frame);
-        }
-
-        if (!detectState)
-        {
-            std::string message = "Detection is not active";
-            double fontScale = 1.5;
-            unsigned short thickness = 2;
-            cv::putText(frame, message, cv::Point(30, 50), cv::FONT_HERSHEY_SIMPLEX, fontScale, cv::Scalar(0, 0, 255), thickness);
-        }
-
-        cv::resize(frame, frame, cv::Size(), 0.75, 0.75);
-        cv::imshow("Webcam", frame);
-
-        if (cv::waitKey(30) >= 0)
-            break;
+    if (inputThreadRunning.load())
+    {
+        std::cout << "End of source, enter 'exit' to quit." << std::endl;
     }
 
-    capture.release();
-    cv::destroyAllWindows();
-
     if (inputThread.joinable())
     {
         inputThread.join();
     }
 }
 
-void Detector::BatchMode(std::string ShapeType, std::string ColorType)
+bool Detector::setQuery(const std::string &shape, const std::string &color)
 {
+    if (!isValidShape(shape) || !isValidColor(color))
+    {
+        return false;
+    }
+
+    setQueries({Query{ShapeClassifier::shapeClassFromName(shape), ColorTable::shared().find(color)}});
+    return true;
+}
+
+void Detector::setQueries(const std::vector<Query> &queries)
+{
+    queryChannel.publish(queries);
+}
 
-    cv::VideoCapture cap(0);
+void Detector::clearQuery()
+{
+    queryChannel.deactivate();
+}
+
+bool Detector::snapshotQueries(std::shared_ptr<const QuerySnapshot> &snapshot) const
+{
+    queryChannel.refresh(snapshot);
+    return snapshot->active;
+}
 
-    if (!cap.isOpened())
+bool Detector::openControlSocket(const std::string &path)
+{
+    return commandInput.listen(path);
+}
+
+bool Detector::isRunning() const
+{
+    return inputThreadRunning.load();
+}
+
+void Detector::stop()
+{
+    inputThreadRunning = false;
+}
+
+void Detector::BatchMode(FrameSource &source, ShapeClass shapeClass, uchar colorId)
+{
+    if (!source.isOpened() || shapeClass == ShapeClass::None || colorId == ColorTable::none)
     {
-        std::cerr << "Error: Could not open camera" << std::endl;
         return;
     }
 
     batchMode = true;
+    this->shape = shapeClass;
+    this->color = colorId;
+    std::string location = source.isLive() && source.getLocation().empty() ? "0" : source.getLocation();
 
-    cv::Mat frame;
-    cap >> frame;
+    source.rewind();
 
-    if (isValidShape(ShapeType) && isValidColor(ColorType))
+    cv::Mat frame;
+    while (source.read(frame))
     {
-        this->shape = ShapeType;
-        this->color = ColorType;
+        setFrameOrigin(location, source.getFrameIndex());
+        foundShape = false;
         detectShapes(frame);
+
+        if (source.isLive())
+        {
+            break;
+        }
     }
-    cv::resize(frame, frame, cv::Size(), 0.5, 0.5);
-    cv::imshow("Detected Shapes", frame);
-    cv::waitKey(2500);
 }
 
 void Detector::inputThread()
 {
-    std::string input;
-    while (inputThreadRunning)
+    commandInput.run(inputThreadRunning, [this](const std::string &input)
+                     { handleCommand(input); });
+}
+
+void Detector::handleCommand(const std::string &input)
+{
+    if (input == "stop")
     {
-        std::getline(std::cin, input);
-        if (input == "stop")
-        {
-            inputThreadDetect = false;
-            std::cout << "Detection stopped" << std::endl;
-        }
-        else if (input == "exit")
+        clearQuery();
+        std::cout << "Detection stopped" << std::endl;
+    }
+    else if (input == "exit")
+    {
+        inputThreadRunning = false;
+    }
+    else if (input.find_first_not_of(" \t\r") != std::string::npos)
+    {
+        Query query;
+        if (parseQuery(input, query))
         {
-            inputThreadRunning = false;
+            setQueries({query});
         }
-        else
-        {
-            std::istringstream iss(input);
-            std::vector<std::string> words(std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>());
-
-            if (words.size() < 2)
-                continue;
+    }
+}
 
-            std::string color = words.back();
-            words.pop_back();
+bool Detector::parseQuery(const std::string &text, Query &query)
+{
+    std::istringstream iss(text);
+    std::vector<std::string> words(std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>());
 
-            std::string shape = std::accumulate(std::next(words.begin()), words.end(), words[0],
-                                                [](std::string a, std::string b)
-                                                { return std::move(a) + ' ' + std::move(b); });
+    // Options follow the color; everything before the color is the shape.
+    query = Query();
+    while (!words.empty())
+    {
+        const std::string &word = words.back();
+        std::size_t split = word.find('=');
+        std::string option = word.substr(0, split);
+        std::string value = split == std::string::npos ? "" : word.substr(split + 1);
+        std::transform(option.begin(), option.end(), option.begin(), ::tolower);
 
-            std::transform(shape.begin(), shape.end(), shape.begin(), ::tolower);
-            std::transform(color.begin(), color.end(), color.begin(), ::tolower);
-            if (isValidShape(shape) && isValidColor(color))
+        try
+        {
+            if (option == "first" && value.empty())
+                query.stopAtFirst = true;
+            else if (option == "top" && !value.empty())
+                query.maxResults = static_cast<size_t>(std::max(0, std::stoi(value)));
+            else if (option == "min" && !value.empty())
+                query.minConfidence = std::stod(value);
+            else if (split != std::string::npos)
             {
-                inputThreadDetect = true;
-                this->shape = shape;
-                this->color = color;
+                std::cerr << "Invalid query option: " << word << std::endl;
+                return false;
             }
+            else
+                break;
         }
+        catch (const std::exception &)
+        {
+            std::cerr << "Invalid query option: " << word << std::endl;
+            return false;
+        }
+        words.pop_back();
     }
-}
-
-void Detector::preProcessImage()
-{
-    unsigned long long startTick = cv::getCPUTickCount();
-
-    cv::Mat hsvImage;
-    cv::cvtColor(inputImage, hsvImage, cv::COLOR_BGR2HSV);
 
-    cv::Mat mask;
-    cv::inRange(hsvImage, cv::Scalar(93, 14, 44), cv::Scalar(144, 255, 255), mask);
-
-    cv::Mat filteredImage;
-    cv::bitwise_and(inputImage, inputImage, filteredImage, mask);
-
-    cv::Mat grayImage;
-    cv::cvtColor(filteredImage, grayImage, cv::COLOR_BGR2GRAY);
-
-    cv::Canny(grayImage, cannyOutputImage, 150, 200, 3);
+    if (words.size() < 2)
+    {
+        std::cerr << "Invalid query: " << text << std::endl;
+        return false;
+    }
 
-    cv::findContours(cannyOutputImage, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    std::string color = words.back();
+    words.pop_back();
+    std::string shape = std::accumulate(std::next(words.begin()), words.end(), words[0],
+                                        [](std::string a, std::string b)
+                                        { return std::move(a) + ' ' + std::move(b); });
 
-    shapesVector.clear();
-    for (size_t i = 0; i < contours.size(); i++)
+    query.shape = ShapeClassifier::shapeClassFromName(shape);
+    query.color = ColorTable::shared().find(color);
+    if (query.shape == ShapeClass::None)
     {
-        shapesVector.push_back(Shape());
-        shapesVector[i].setClocktickBegin(startTick);
+        std::cerr << "Invalid shape: " << shape << std::endl;
+        return false;
     }
-
-    if (contours.size() != shapesVector.size())
+    if (query.color == ColorTable::none)
     {
-        std::cerr << "Error: contours and shapes vector are not the same size" << std::endl;
+        std::cerr << "Invalid color: " << color << std::endl;
+        return false;
     }
+    return true;
 }
 
-void Detector::labelShape(cv::Mat &image, short ID)
+void Detector::preProcessImage()
 {
-    foundShape = true;
-    cv::Point position = shapesVector[ID].getShapePosition();
-
-    double time = (shapesVector[ID].getShapeClocktickEnd() - shapesVector[ID].getShapeClocktickBegin()) / cv::getTickFrequency();
-
-    std::string formattedLabel = shapesVector[ID].getShapeName() + " - " + shapesVector[ID].getShapeColor() +
-                                 " - Pos: (" + std::to_string(position.x) + ", " + std::to_string(position.y) + ")" + " - Time: " + std::to_string(time) + " s";
-
-    if (batchMode)
+    frameClocktickBegin = cv::getTickCount();
+    frameTimings.preprocess = 0.0;
+    frameTimings.edges = 0.0;
+    frameTimings.contours = 0.0;
+    contours.clear();
+    contourColors.clear();
+
+    if (pyramidLevels > 0)
     {
-        std::cout << formattedLabel << std::endl;
+        findCandidateRegions();
+        for (const cv::Rect &region : candidateRegions)
+        {
+            segmentRegion(region);
+        }
     }
     else
     {
-        unsigned short fontFace = cv::FONT_HERSHEY_SIMPLEX;
-        double fontScale = 0.35;
-        unsigned short thickness = 1;
-        cv::Size textSize = cv::getTextSize(formattedLabel, fontFace, fontScale, thickness, 0);
-        cv::Point textOrg = cv::Point(position.x - textSize.width / 2, position.y + 0);
+        segmentRegion(searchRect);
+    }
+}
 
-        textOrg.x = std::max(0, textOrg.x);
-        textOrg.y = std::max(0, textOrg.y);
-        textOrg.x = std::min(image.cols - textSize.width, textOrg.x);
-        textOrg.y = std::min(image.rows - textSize.height, textOrg.y);
+void Detector::segmentRegion(const cv::Rect &region)
+{
+    if (segmentation == Segmentation::ColorLabels)
+    {
+        segmentColorLabels(region);
+        return;
+    }
+
+    int64 preprocessBegin = cv::getTickCount();
+    {
+        TRACE_SCOPE("preprocess.maskedGray");
+        preprocessor.maskedGray(inputImage(region), grayImage);
+    }
+    int64 edgesBegin = cv::getTickCount();
 
-        cv::Mat overlay = image.clone();
-        cv::rectangle(overlay, textOrg + cv::Point(0, 0), textOrg + cv::Point(textSize.width, -textSize.height - 0), cv::Scalar(255, 255, 255, 120), cv::FILLED);
-        double alpha = 0.4;
-        cv::addWeighted(overlay, alpha, image, 1 - alpha, 0, image);
+    {
+        TRACE_SCOPE("preprocess.canny");
+        cv::Canny(grayImage, cannyOutputImage, cannyThresholds.low, cannyThresholds.high, 3);
+    }
+    int64 contoursBegin = cv::getTickCount();
 
-        cv::putText(image, formattedLabel, textOrg, fontFace, fontScale, cv::Scalar(0, 0, 0), thickness);
+    {
+        TRACE_SCOPE("findContours");
+        cv::findContours(cannyOutputImage, regionContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, region.tl());
+        appendRegionContours(ColorTable::none);
     }
+
+    frameTimings.preprocess += (edgesBegin - preprocessBegin) / cv::getTickFrequency();
+    frameTimings.edges += (contoursBegin - edgesBegin) / cv::getTickFrequency();
+    frameTimings.contours += (cv::getTickCount() - contoursBegin) / cv::getTickFrequency();
 }
 
-void Detector::detectTriangle(std::string ColorType)
+void Detector::segmentColorLabels(const cv::Rect &region)
 {
-
-    for (size_t i = 0; i < contours.size(); i++)
+    int64 preprocessBegin = cv::getTickCount();
     {
-        std::vector<cv::Point> approx;
-        cv::approxPolyDP(contours[i], approx, cv::arcLength(contours[i], true) * 0.02, true);
+        TRACE_SCOPE("preprocess.labelMap");
+        preprocessor.labelMap(inputImage(region), labelImage);
+    }
+    int64 contoursBegin = cv::getTickCount();
 
-        if (fabs(cv::contourArea(contours[i])) < 100 || !cv::isContourConvex(approx))
+    {
+        TRACE_SCOPE("findContours");
+        const std::vector<ColorClass> &classes = colorTable->getClasses();
+        for (size_t c = 0; c < classes.size(); c++)
         {
-            continue;
+            uchar id = static_cast<uchar>(c + 1);
+            cv::compare(labelImage, id, labelMask, cv::CMP_EQ);
+            cv::findContours(labelMask, regionContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, region.tl());
+            appendRegionContours(id);
         }
+    }
 
-        if (approx.size() == 3)
-        {
-            cv::Rect boundingRect = cv::boundingRect(approx);
-
-            setShape("Driehoek", cv::Point(boundingRect.x + boundingRect.width / 2, boundingRect.y + boundingRect.height / 2), cv::getCPUTickCount(), false, i);
-            shapesVector[i].detectShapeColor(inputImage, contours[i]);
+    frameTimings.preprocess += (contoursBegin - preprocessBegin) / cv::getTickFrequency();
+    frameTimings.contours += (cv::getTickCount() - contoursBegin) / cv::getTickFrequency();
+}
 
-            if (shapesVector[i].getShapeColor() == ColorType)
-            {
-                cv::drawContours(inputImage, contours, (unsigned short)i, cv::Scalar(0, 255, 0), 2);
-                labelShape(inputImage, i);
-            }
-        }
+void Detector::appendRegionContours(uchar color)
+{
+    for (const std::vector<cv::Point> &contour : regionContours)
+    {
+        contours.add(contour, frameArena);
     }
+    contourColors.resize(contours.size(), color);
 }
 
-void Detector::detectSquare(std::string ColorType)
+void Detector::findCandidateRegions()
 {
-    for (size_t i = 0; i < contours.size(); i++)
+    TRACE_SCOPE("preprocess.pyramid");
+    int64 pyramidBegin = cv::getTickCount();
+
+    int factor = 1 << pyramidLevels;
+    double scale = 1.0 / factor;
+    cv::resize(inputImage(searchRect), pyramidImage, cv::Size(), scale, scale, cv::INTER_AREA);
+    preprocessor.maskedGray(pyramidImage, grayImage);
+    cv::Canny(grayImage, cannyOutputImage, cannyThresholds.low, cannyThresholds.high, 3);
+    cv::findContours(cannyOutputImage, regionContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    // A shape that passes the full resolution area threshold covers factor^2 fewer pixels here.
+    double minCandidateArea = classifier.getMinArea() * scale * scale;
+    int margin = 2 * factor;
+
+    candidateRegions.clear();
+    for (const std::vector<cv::Point> &contour : regionContours)
     {
-        int64 startTick = cv::getCPUTickCount();
-        std::vector<cv::Point> approx;
-
-        cv::approxPolyDP(contours[i], approx, cv::arcLength(contours[i], true) * 0.02, true);
-
-        if (fabs(cv::contourArea(contours[i])) < 100 || !cv::isContourConvex(approx))
+        cv::Rect box = cv::boundingRect(contour);
+        if (box.area() < minCandidateArea)
         {
             continue;
         }
 
-        if (approx.size() == 4)
-        {
-
-            double min_distance = std::numeric_limits<double>::max();
-            double max_distance = 0.0;
+        cv::Rect region(searchRect.x + box.x * factor - margin, searchRect.y + box.y * factor - margin,
+                        box.width * factor + 2 * margin, box.height * factor + 2 * margin);
+        region &= searchRect;
 
-            for (size_t j = 0; j < approx.size(); j++)
+        // Overlapping regions are merged, so no shape is segmented twice.
+        for (size_t i = 0; i < candidateRegions.size();)
+        {
+            if ((candidateRegions[i] & region).area() > 0)
             {
-                double distance = cv::norm(approx[j] - approx[(j + 1) % approx.size()]);
-
-                if (distance < min_distance)
-                {
-                    min_distance = distance;
-                }
-                if (distance > max_distance)
-                {
-                    max_distance = distance;
-                }
+                region |= candidateRegions[i];
+                candidateRegions[i] = candidateRegions.back();
+                candidateRegions.pop_back();
+                i = 0;
             }
-
-            float ratio = max_distance / min_distance;
-            if (ratio <= 1.3 && ratio >= 0.7)
+            else
             {
-                cv::Rect boundingRect = cv::boundingRect(approx);
-                setShape("Vierkant", cv::Point(boundingRect.x + boundingRect.width / 2, boundingRect.y + boundingRect.height / 2), startTick, false, i);
-                shapesVector[i].detectShapeColor(inputImage, contours[i]);
-                if (shapesVector[i].getShapeColor() == ColorType)
-                {
-                    cv::drawContours(inputImage, contours, (unsigned short)i, cv::Scalar(0, 255, 0), 2);
-                    labelShape(inputImage, i);
-                }
+                i++;
             }
         }
+        candidateRegions.push_back(region);
     }
+
+    frameTimings.preprocess += (cv::getTickCount() - pyramidBegin) / cv::getTickFrequency();
 }
 
-void Detector::detectRectangle(std::string ColorType)
+void Detector::labelShape(size_t ID)
 {
-    for (size_t i = 0; i < contours.size(); i++)
+    TRACE_SCOPE("render.label");
+    foundShape = true;
+    cv::Point position = detections.getCentroid(ID);
+
+    double time = (detections.getClocktickEnd(ID) - detections.getClocktickBegin(ID)) / cv::getTickFrequency();
+
+    if (resultSink)
     {
-        std::vector<cv::Point> approx;
-        cv::approxPolyDP(contours[i], approx, cv::arcLength(contours[i], true) * 0.02, true);
+        record.found = true;
+        record.trackId = detections.getTrackId(ID);
+        record.shape = ShapeClassifier::getShapeClassKey(detections.getShapeClass(ID));
+        record.color = colorTable->getName(detections.getColor(ID));
+        record.centroid = position;
+        record.boundingBox = detections.getBoundingBox(ID);
+        record.area = detections.getArea(ID);
+        record.confidence = detections.getConfidence(ID);
+        record.shapeTime = time;
+        record.frameTime = (cv::getTickCount() - frameClocktickBegin) / cv::getTickFrequency();
+        resultSink->write(record);
+    }
+    if (!batchMode && annotate)
+    {
+        labelText.assign("#");
+        labelText += std::to_string(detections.getTrackId(ID));
+        labelText += " ";
+        labelText += ShapeClassifier::getShapeClassName(detections.getShapeClass(ID));
+        labelText += " - ";
+        labelText += colorTable->getName(detections.getColor(ID));
+        labelText += " - Pos: (";
+        labelText += std::to_string(position.x);
+        labelText += ", ";
+        labelText += std::to_string(position.y);
+        labelText += ") - Conf: ";
+        labelText += std::to_string(detections.getConfidence(ID));
+        labelText += " - Time: ";
+        labelText += std::to_string(time);
+        labelText += " s";
+        drawList.addLabel(position, labelText);
+    }
+}
 
-        if (fabs(cv::contourArea(contours[i])) < 100 || !cv::isContourConvex(approx))
+void Detector::classifyContours(const std::vector<Query> &queries)
+{
+    TRACE_SCOPE("classify");
+    contourFeatures.resize(contours.size());
+    contourClocktickBegins.resize(contours.size());
+    contourClocktickEnds.resize(contours.size());
+    detections.clear();
+    rejectStats = RejectStats();
+
+    bool stopEarly = !queries.empty() && std::all_of(queries.begin(), queries.end(), [](const Query &query)
+                                                     { return query.stopAtFirst; });
+    foundQueries.assign(queries.size(), 0);
+
+    // Batches double in size, so a frame without matches costs at most a few extra passes.
+    size_t begin = 0;
+    size_t batch = stopEarly ? minParallelContours : contours.size();
+    while (begin < contours.size())
+    {
+        size_t end = std::min(contours.size(), begin + batch);
+        size_t firstDetection = detections.size();
+        classifyBatch(cv::Range(static_cast<int>(begin), static_cast<int>(end)));
+        begin = end;
+        batch *= 2;
+
+        if (stopEarly && allQueriesFound(queries, firstDetection))
         {
-            continue;
+            break;
         }
+    }
 
-        cv::Rect boundingRect = cv::boundingRect(approx);
-        double aspectRatio = (double)boundingRect.width / boundingRect.height;
-        double adjustedAspectRatio = aspectRatio > 1 ? aspectRatio : 1 / aspectRatio;
-        if ((approx.size() == 4 && adjustedAspectRatio > 1.1) || adjustedAspectRatio < 0.9)
-        {
-            setShape("Rechthoek", cv::Point(boundingRect.x + boundingRect.width / 2, boundingRect.y + boundingRect.height / 2), cv::getCPUTickCount(), false, i);
-            shapesVector[i].detectShapeColor(inputImage, contours[i]);
+    // Contours after an early stop keep no stale features from an earlier frame.
+    std::fill(contourFeatures.begin() + begin, contourFeatures.end(), ContourFeatures());
+}
 
-            if (shapesVector[i].getShapeColor() == ColorType)
+void Detector::classifyBatch(const cv::Range &range)
+{
+    auto classifyRange = [this](const cv::Range &range)
+    {
+        // The per shape time covers only the geometric classification of this contour. The end of
+        // one contour is the begin of the next, so a rejected fragment costs one tick read.
+        int64 tick = cv::getTickCount();
+        for (int i = range.start; i < range.end; i++)
+        {
             {
-                cv::drawContours(inputImage, contours, (unsigned short)i, cv::Scalar(0, 255, 0), 2);
-                labelShape(inputImage, i);
+                TRACE_SCOPE("classify.contour");
+                contourFeatures[i] = classifier.analyze(contours[i].points, contours[i].size);
             }
+            contourClocktickBegins[i] = tick;
+            tick = cv::getTickCount();
+            contourClocktickEnds[i] = tick;
         }
+    };
+
+    size_t count = static_cast<size_t>(range.size());
+    if (count < minParallelContours)
+    {
+        classifyRange(range);
+    }
+    else
+    {
+        cv::parallel_for_(range, classifyRange, static_cast<double>(count) / minParallelContours);
+    }
+
+    size_t firstDetection = detections.size();
+    for (int i = range.start; i < range.end; i++)
+    {
+        const ContourFeatures &features = contourFeatures[i];
+        rejectStats.add(features.rejectedBy, features.shapeClass);
+        if (features.shapeClass != ShapeClass::None)
+        {
+            detections.add(i, features.shapeClass, features.center, features.boundingRect, features.area,
+                           features.confidence, contourClocktickBegins[i], contourClocktickEnds[i]);
+        }
+    }
+
+    if (segmentation == Segmentation::ColorLabels)
+    {
+        for (size_t d = firstDetection; d < detections.size(); d++)
+        {
+            detections.setColor(d, contourColors[detections.getContour(d)]);
+        }
+        return;
+    }
+
+    // The colors of all classified contours of the batch are measured over their interiors in one shared pass.
+    TRACE_SCOPE("classify.color");
+    colorStatistics.compute(inputImage, contours, contourFeatures, regionColors, range);
+    const ColorTable &table = *colorTable;
+    for (size_t d = firstDetection; d < detections.size(); d++)
+    {
+        const RegionColor &region = regionColors[detections.getContour(d)];
+        cv::Vec3b bgr = region.pixels > 0 ? region.median : inputImage.at<cv::Vec3b>(detections.getCentroid(d));
+        detections.setColor(d, table.classify(bgr[0], bgr[1], bgr[2]));
     }
 }
 
-void Detector::detectCircle(std::string ColorType)
+bool Detector::allQueriesFound(const std::vector<Query> &queries, size_t firstDetection)
 {
+    bool allFound = true;
+    for (size_t q = 0; q < queries.size(); q++)
+    {
+        const Query &query = queries[q];
+        for (size_t d = firstDetection; d < detections.size() && !foundQueries[q]; d++)
+        {
+            foundQueries[q] = detections.getShapeClass(d) == query.shape && detections.getColor(d) == query.color &&
+                              detections.getConfidence(d) >= query.minConfidence;
+        }
+        allFound = allFound && foundQueries[q];
+    }
+    return allFound;
+}
 
-    for (size_t i = 0; i < contours.size(); i++)
+bool Detector::answerQuery(const Query &query)
+{
+    // None would act as a wildcard in DetectionStore::select().
+    if (query.shape == ShapeClass::None || query.color == ColorTable::none)
     {
-        std::vector<cv::Point> approx;
-        cv::approxPolyDP(contours[i], approx, cv::arcLength(contours[i], true) * 0.02, true);
+        return false;
+    }
 
-        if (fabs(cv::contourArea(contours[i])) < 100 || !cv::isContourConvex(approx))
+    queryMatches.clear();
+    for (size_t d : detections.select(query.shape, query.color))
+    {
+        if (detections.getConfidence(d) < query.minConfidence)
         {
             continue;
         }
-
-        cv::Rect boundingRect = cv::boundingRect(approx);
-        double aspectRatio = (double)boundingRect.width / boundingRect.height;
-        double area = cv::contourArea(contours[i]);
-        double arcLength = cv::arcLength(contours[i], true);
-        double circularity = 4 * M_PI * area / (arcLength * arcLength);
-
-        if (circularity > 0.8 && std::abs(aspectRatio - 1) < 0.2)
+        queryMatches.push_back(d);
+        if (query.stopAtFirst)
         {
-            cv::Point2f center;
-            float radius;
-            cv::minEnclosingCircle(contours[i], center, radius);
+            break;
+        }
+    }
 
-            setShape("Cirkel", cv::Point(center.x, center.y), cv::getCPUTickCount(), false, i);
-            shapesVector[i].detectShapeColor(inputImage, contours[i]);
+    // Only the most confident matches are kept; equal confidences stay in contour order.
+    if (query.maxResults > 0 && queryMatches.size() > query.maxResults)
+    {
+        std::partial_sort(queryMatches.begin(), queryMatches.begin() + query.maxResults, queryMatches.end(),
+                          [this](size_t a, size_t b)
+                          {
+                              double confidenceA = detections.getConfidence(a);
+                              double confidenceB = detections.getConfidence(b);
+                              return confidenceA > confidenceB || (confidenceA == confidenceB && a < b);
+                          });
+        queryMatches.resize(query.maxResults);
+    }
 
-            if (shapesVector[i].getShapeColor() == ColorType)
+    for (size_t d : queryMatches)
+    {
+        // A detection answering several queries is tracked, drawn and reported only once per frame.
+        if (detections.isMatched(d))
+        {
+            continue;
+        }
+        detections.setMatched(d, true);
+        if (detections.getTrackId(d) == -1)
+        {
+            detections.setTrackId(d, assignTrack(d));
+        }
+        if (annotate && !batchMode)
+        {
+            TRACE_SCOPE("render.contour");
+            int contour = detections.getContour(d);
+            if (query.shape == ShapeClass::Circle)
+            {
+                drawList.addCircle(detections.getCentroid(d), static_cast<int>(contourFeatures[contour].radius), cv::Scalar(0, 255, 0));
+            }
+            else
             {
-                cv::circle(inputImage, center, static_cast<unsigned long>(radius), cv::Scalar(0, 255, 0), 2);
-                labelShape(inputImage, i);
+                // Copied out of the frame arena, which is reset before the list is drawn.
+                drawList.addOutline(contours[contour].points, contours[contour].size, cv::Scalar(0, 255, 0));
             }
         }
+        labelShape(d);
     }
+
+    // A match already reported for an earlier query still answers this one.
+    foundShape = foundShape || !queryMatches.empty();
+    return !queryMatches.empty();
 }
 
-void Detector::detectHalfCircle(std::string ColorType)
+void Detector::chooseSearchRect()
 {
-    for (size_t i = 0; i < contours.size(); i++)
-    {
+    cv::Rect frameRect(0, 0, inputImage.cols, inputImage.rows);
+    bool fullSearch = !trackingConfig.enabled || tracks.empty() || trackingMiss || framesSinceFullSearch + 1 >= trackingConfig.fullSearchInterval;
+    trackingMiss = false;
 
-        std::vector<cv::Point> approx;
-
-        cv::approxPolyDP(contours[i], approx, cv::arcLength(contours[i], true) * 0.02, true);
-
-        if (fabs(cv::contourArea(contours[i])) < 100 || !cv::isContourConvex(approx))
+    if (!fullSearch)
+    {
+        searchRect = cv::Rect();
+        for (const Track &track : tracks)
         {
-            continue;
+            int margin = std::max(trackingConfig.minRoiMargin, static_cast<int>(trackingConfig.roiMargin * std::max(track.box.width, track.box.height)));
+            cv::Rect region(track.box.x - margin, track.box.y - margin, track.box.width + 2 * margin, track.box.height + 2 * margin);
+            searchRect = searchRect.empty() ? region : (searchRect | region);
         }
+        searchRect &= frameRect;
+        fullSearch = searchRect.empty();
+    }
 
-        cv::Rect boundingRect = cv::boundingRect(approx);
-        double aspectRatio = (double)boundingRect.width / boundingRect.height;
-        double area = cv::contourArea(contours[i]);
-        double arcLength = cv::arcLength(contours[i], true);
-        double circularity = 4 * M_PI * area / (arcLength * arcLength);
+    if (fullSearch)
+    {
+        searchRect = frameRect;
+        framesSinceFullSearch = 0;
+    }
+    else
+    {
+        framesSinceFullSearch++;
+    }
+}
 
-        if (circularity > 0.8 && std::abs(aspectRatio - 1) < 0.2)
+int Detector::assignTrack(size_t ID)
+{
+    ShapeClass shapeClass = detections.getShapeClass(ID);
+    uchar shapeColor = detections.getColor(ID);
+    const cv::Rect &box = detections.getBoundingBox(ID);
+    cv::Point center = detections.getCentroid(ID);
+
+    // A shape continues the closest track of the same kind that it could have moved from.
+    int best = -1;
+    double bestDistance = std::max(box.width, box.height);
+    for (size_t t = 0; t < tracks.size(); t++)
+    {
+        const Track &track = tracks[t];
+        if (track.updated || track.shapeClass != shapeClass || track.color != shapeColor)
         {
             continue;
         }
 
-        if (approx.size() > 4)
+        cv::Point trackCenter(track.box.x + track.box.width / 2, track.box.y + track.box.height / 2);
+        double distance = cv::norm(center - trackCenter);
+        if (distance <= bestDistance)
         {
-            cv::Rect boundingRect = cv::boundingRect(approx);
-            setShape("Halve Cirkel", cv::Point(boundingRect.x + boundingRect.width / 2, boundingRect.y + boundingRect.height / 2), cv::getCPUTickCount(), false, i);
-            shapesVector[i].detectShapeColor(inputImage, contours[i]);
-
-            if (shapesVector[i].getShapeColor() == ColorType)
-            {
-                cv::drawContours(inputImage, contours, (unsigned short)i, cv::Scalar(0, 255, 0), 2);
-                labelShape(inputImage, i);
-            }
+            best = static_cast<int>(t);
+            bestDistance = distance;
         }
     }
+
+    if (best < 0)
+    {
+        Track track;
+        track.id = nextTrackId++;
+        track.shapeClass = shapeClass;
+        track.color = shapeColor;
+        tracks.push_back(track);
+        best = static_cast<int>(tracks.size()) - 1;
+    }
+
+    tracks[best].box = box;
+    tracks[best].updated = true;
+    return tracks[best].id;
+}
+
+void Detector::updateTracks()
+{
+    size_t before = tracks.size();
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [](const Track &track)
+                                { return !track.updated; }),
+                 tracks.end());
+    if (tracks.size() != before)
+    {
+        trackingMiss = true;
+    }
+
+    for (Track &track : tracks)
+    {
+        track.updated = false;
+    }
+}
+
+bool Detector::isKnownShape(const std::string &shape)
+{
+    return ShapeClassifier::shapeClassFromName(shape) != ShapeClass::None;
 }
 
-void Detector::setShape(std::string shape, cv::Point position, long long clocktickEnd, bool correctShapeAndColor, short ID)
+bool Detector::isKnownColor(const std::string &color)
 {
-    shapesVector[ID].setShapeName(shape);
-    shapesVector[ID].setShapePosition(position);
-    shapesVector[ID].setClocktickEnd(clocktickEnd);
-    shapesVector[ID].setCorrectShapeAndColor(correctShapeAndColor);
+    return ColorTable::shared().find(color) != ColorTable::none;
 }
 
 bool Detector::isValidShape(std::string shape)
 {
-    if (shape != "cirkel" && shape != "halve cirkel" && shape != "vierkant" && shape != "driehoek" && shape != "rechthoek")
+    if (!isKnownShape(shape))
     {
         std::cerr << "Invalid shape: " << shape << std::endl;
         detectState = false;
@@ -449,7 +848,7 @@ bool Detector::isValidShape(std::string shape)
 
 bool Detector::isValidColor(std::string color)
 {
-    if (color != "roze" && color != "groen" && color != "geel" && color != "oranje")
+    if (!isKnownColor(color))
     {
         std::cerr << "Invalid color: " << color << std::endl;
         detectState = false;
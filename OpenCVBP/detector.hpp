@@ -9,9 +9,103 @@
 #include <thread>
 #include <numeric>
 #include <iterator>
+#include <mutex>
 
 #include <opencv2/opencv.hpp>
-#include "shape.hpp"
+#include "shapeClassifier.hpp"
+#include "detectionStore.hpp"
+#include "frameArena.hpp"
+#include "contourList.hpp"
+#include "preprocessor.hpp"
+#include "allocationCounter.hpp"
+#include "frameSource.hpp"
+#include "trace.hpp"
+#include "resultSink.hpp"
+#include "colorStatistics.hpp"
+#include "detectorProfile.hpp"
+#include "queryChannel.hpp"
+#include "commandInput.hpp"
+#include "drawList.hpp"
+
+/**
+ * @struct FrameTimings
+ * @brief Wall-clock duration, in seconds, of each stage of the last detectShapes() call.
+ */
+struct FrameTimings
+{
+    /** Fused color masking and grayscale conversion. */
+    double preprocess = 0.0;
+
+    /** Canny edge detection. */
+    double edges = 0.0;
+
+    /** Contour extraction, including resetting the shape storage. */
+    double contours = 0.0;
+
+    /** Shape classification and color measurement of all contours. */
+    double classify = 0.0;
+
+    /** Answering the queries, including drawing and labelling. */
+    double queries = 0.0;
+
+    /** The whole call. */
+    double total = 0.0;
+};
+
+/**
+ * @enum Segmentation
+ * @brief How a frame is cut into the contours that are classified.
+ */
+enum class Segmentation
+{
+    /** Canny edges of the color-masked grayscale image; the color of every shape is measured afterwards. */
+    Edges,
+    /** One color-class label per pixel, with contours extracted per label; the color follows from the label. */
+    ColorLabels
+};
+
+/**
+ * @struct TrackingConfig
+ * @brief Parameters of temporal region-of-interest tracking (see Detector::setTracking).
+ */
+struct TrackingConfig
+{
+    /** Whether frames after a detection are only searched around the shapes found before. */
+    bool enabled = false;
+
+    /** A full-frame search runs at least once every this many frames. */
+    int fullSearchInterval = 30;
+
+    /** Margin added on every side of a tracked bounding box, as a fraction of its largest side. */
+    double roiMargin = 0.5;
+
+    /** Minimum margin in pixels, so small or fast moving shapes stay inside their region. */
+    int minRoiMargin = 16;
+};
+
+/**
+ * @struct Track
+ * @brief A detected shape followed from frame to frame under a stable ID.
+ */
+struct Track
+{
+    /** ID of the track, unique for the lifetime of the detector. */
+    int id = 0;
+
+    /** Shape class of the tracked shape. */
+    ShapeClass shapeClass = ShapeClass::None;
+
+    /** Color class ID of the tracked shape. */
+    uchar color = ColorTable::none;
+
+    /** Bounding box of the shape in the frame it was last seen. */
+    cv::Rect box;
+
+    /** Whether the shape was seen in the current frame. */
+    bool updated = false;
+};
+
+struct PipelineConfig;
 
 /**
  * @class Detector
@@ -38,7 +132,183 @@ public:
      *
      * @param image The input image in which to detect shapes.
      */
-    void detectShapes(cv::Mat image);
+    void detectShapes(cv::Mat &image);
+
+    /**
+     * @brief Detects any number of shape and color combinations in a given image.
+     *
+     * The image is preprocessed and every contour is classified (shape class and color) exactly
+     * once; each query is then answered from that cached classification, so looking for several
+     * combinations costs about as much as looking for one.
+     *
+     * All intermediate images, the contour and shape storage and the label text are owned by the
+     * detector and reused from frame to frame, so once the buffers have grown to the frame size and
+     * contour count of a stream, detection itself makes no heap allocations of its own. The number of
+     * allocations made during the call is available from getFrameAllocations().
+     *
+     * Every classified shape carries a confidence, and a query can ask for only its most confident
+     * matches or for the first good enough one (see Query). When every query stops at its first
+     * match, contours are classified in batches in contour order and the rest of the frame is
+     * skipped as soon as each query has its match.
+     *
+     * @param image The input image in which to detect shapes.
+     * @param queries The shape and color combinations to look for.
+     */
+    void detectShapes(cv::Mat &image, const std::vector<Query> &queries);
+
+    /**
+     * @brief Returns the number of heap allocations made during the last detectShapes() call.
+     *
+     * The count is process-wide (see AllocationCounter), so it includes allocations made inside
+     * OpenCV and by OpenCV worker threads while the frame was processed.
+     *
+     * @return The allocation count of the last frame.
+     */
+    unsigned long long getFrameAllocations() const;
+
+    /** @return The number of queries of the last detectShapes() call that matched nothing. */
+    unsigned getFrameMisses() const;
+
+    /**
+     * @brief Returns how the per-frame arena was used during the last detectShapes() call.
+     *
+     * The points of every contour of a frame are stored in one arena that is reset when the
+     * frame is done; in steady state it serves all contours without a heap allocation.
+     *
+     * @return The arena usage of the last frame.
+     */
+    const ArenaStats &getArenaStats() const;
+
+    /**
+     * @brief Returns how many contours of the last detectShapes() call each stage of the rejection cascade discarded.
+     *
+     * @return The rejection counts of the last frame (see ShapeClassifier).
+     */
+    const RejectStats &getRejectStats() const;
+
+    /**
+     * @brief Returns the duration of each stage of the last detectShapes() call.
+     *
+     * @return The stage timings of the last frame.
+     */
+    const FrameTimings &getFrameTimings() const;
+
+    /**
+     * @brief Returns the shapes classified in the last frame.
+     *
+     * Shapes that answered a query are marked matched and carry their track ID; iterate over
+     * them with DetectionStore::matched().
+     *
+     * @return The shapes of the last frame.
+     */
+    const DetectionStore &getDetections() const;
+
+    /**
+     * @brief Enables or disables recording contours and labels in the draw list outside batch mode.
+     *
+     * Detection never draws on the frame itself; the overlays are drawn from the draw list by
+     * whoever displays the frame (see DrawList::render()). Headless consumers such as the
+     * benchmark disable annotation so no draw list is built at all.
+     *
+     * @param annotate True to record overlays (the default), false to skip them.
+     */
+    void setAnnotate(bool annotate);
+
+    /** @return The overlays of the last frame. */
+    const DrawList &getDrawList() const;
+
+    /**
+     * @brief Exchanges the overlays of the last frame with another list, without copying.
+     *
+     * The detector clears whatever list it gets back at the start of the next frame, so passing
+     * a recycled list lets both keep their capacity.
+     *
+     * @param list Receives the overlays; its previous contents become the detector's list.
+     */
+    void swapDrawList(DrawList &list);
+
+    /**
+     * @brief Sets where detection records are written.
+     *
+     * Every query answered by detectShapes() then produces one record per matching shape, or one
+     * "not found" record, in the sink's format. Batch mode needs a sink to produce any output.
+     *
+     * @param sink The sink to write to, owned by the caller; nullptr to stop writing records.
+     */
+    void setResultSink(ResultSink *sink);
+
+    /**
+     * @brief Sets the source and frame index written with the records of the next detectShapes() call.
+     *
+     * @param source Location of the source, "0" for the default camera.
+     * @param frame Index of the frame within its source.
+     */
+    void setFrameOrigin(const std::string &source, long long frame);
+
+    /**
+     * @brief Selects how frames are segmented into contours.
+     *
+     * With Segmentation::ColorLabels every pixel is labelled with its color class in one pass
+     * (see Preprocessor::labelMap), and the outer contours of every color class are extracted
+     * from that label map. Shapes of different colors that touch are separated, all configured
+     * colors are segmented at once, and no color measurement is needed.
+     *
+     * @param segmentation The segmentation to use; Segmentation::Edges by default.
+     */
+    void setSegmentation(Segmentation segmentation);
+
+    /**
+     * @brief Enables coarse-to-fine detection on an image pyramid.
+     *
+     * Candidate shapes are first found on the searched region downscaled by 2^levels, where
+     * preprocessing costs 4^levels times less, using a minimum area scaled down by the same
+     * factor. Only the regions around the candidates, mapped back to full resolution with a
+     * margin and merged where they overlap, are then segmented and classified at full
+     * resolution, so the geometry is as accurate as without the pyramid.
+     *
+     * @param levels Number of halvings for the coarse pass, 0 (the default) to disable, at most 4.
+     */
+    void setPyramidLevels(int levels);
+
+    /**
+     * @brief Sets the Canny thresholds of edge segmentation and of the coarse pyramid pass.
+     *
+     * @param thresholds The thresholds; a new detector takes them from DetectorProfile::shared().
+     */
+    void setCannyThresholds(const CannyThresholds &thresholds);
+
+    /**
+     * @brief Sets the color classes used for the mask, the color of every shape and the names in results.
+     *
+     * Queries must use class IDs of this table.
+     *
+     * @param table The table; must outlive the detector. Defaults to ColorTable::shared().
+     */
+    void setColorTable(const ColorTable &table);
+
+    /**
+     * @brief Configures temporal region-of-interest tracking and drops all current tracks.
+     *
+     * Every shape that answers a query is assigned to a track: the track of the same shape
+     * class and color that was closest to it in the previous frame, or a new one. Track IDs are
+     * reported in the records and labels whether tracking is enabled or not.
+     *
+     * With tracking enabled, once a frame produced tracks, the next frames are preprocessed and
+     * searched only within the union of the tracked bounding boxes plus a margin. A full-frame
+     * search runs every `fullSearchInterval` frames, and on the frame after a query matched
+     * nothing or a track was lost, so new shapes are still picked up. Tracking assumes the frames
+     * arrive in order, so use a single detection worker with it.
+     *
+     * @param config The tracking parameters.
+     */
+    void setTracking(const TrackingConfig &config);
+
+    /**
+     * @brief Returns the region the last detectShapes() call searched.
+     *
+     * @return The searched region, the whole frame after a full search.
+     */
+    const cv::Rect &getSearchRect() const;
 
     /**
      * @brief Initiates interactive mode for real-time shape detection from the webcam.
@@ -50,126 +320,241 @@ public:
     void InteractiveMode();
 
     /**
-     * @brief Executes batch mode for detecting a specific shape and color in a single frame from the webcam.
+     * @brief Initiates interactive mode on any frame source, using a staged pipeline.
+     *
+     * Capture, detection and rendering run on separate threads connected by bounded queues
+     * (see Pipeline). The detection threads pick up the query entered by the user, on stdin or the
+     * control socket, at every frame boundary. The mode ends on "exit", a key press in the window,
+     * or when a file based source runs out of frames; frame counters are printed at the end.
+     *
+     * @param location The source to read from, empty for the default camera (see FrameSource::open).
+     * @param config The pipeline configuration.
+     */
+    void InteractiveMode(const std::string &location, const PipelineConfig &config);
+
+    /**
+     * @brief Sets the shape and color to look for, as if the user had typed "shape color". Safe from any thread.
+     *
+     * @param shape Name or alias of the shape, in any case.
+     * @param color Name or alias of the color, in any case.
+     * @return True if the shape and color are valid and detection was activated.
+     */
+    bool setQuery(const std::string &shape, const std::string &color);
+
+    /**
+     * @brief Replaces the queries of interactive mode and activates detection. Safe from any thread.
+     *
+     * @param queries The shape and color combinations to look for.
+     */
+    void setQueries(const std::vector<Query> &queries);
+
+    /**
+     * @brief Stops detection until the next query, as if the user had typed "stop". Safe from any thread.
+     */
+    void clearQuery();
+
+    /**
+     * @brief Brings a detection thread's copy of the queries up to date; call once per frame.
+     *
+     * Never blocks: when no new queries were published since the last call this costs one atomic
+     * load and the snapshot is kept as it is.
      *
-     * Batch mode is designed for processing a single image/frame to detect a specific shape and color,
-     * as specified by the user. It captures a frame, processes it, and displays the result.
+     * @param snapshot The snapshot of the calling thread, may be empty on the first call.
+     * @return True if detection is active, false if it is stopped or no query was set yet.
+     */
+    bool snapshotQueries(std::shared_ptr<const QuerySnapshot> &snapshot) const;
+
+    /**
+     * @brief Accepts interactive mode commands on a Unix domain socket in addition to stdin.
      *
-     * @param ShapeType The shape to detect in the captured frame.
-     * @param ColorType The color of the shape to detect.
+     * @param path File system path of the socket.
+     * @return True if the socket is listening.
      */
-    void BatchMode(std::string ShapeType, std::string ColorType);
+    bool openControlSocket(const std::string &path);
+
+    /** @return False once interactive mode has been asked to end. */
+    bool isRunning() const;
+
+    /**
+     * @brief Asks interactive mode to end.
+     */
+    void stop();
+
+    /**
+     * @brief Executes headless batch mode for detecting a specific shape and color on a frame source.
+     *
+     * Every frame the source delivers is processed without any GUI or delay: file based sources
+     * are processed from their first to their last frame, a camera source contributes one fresh
+     * frame per call. Each detection (or the absence of one) is written as a single record to the
+     * sink set with setResultSink().
+     *
+     * @param source The (already opened) source to read frames from. It is rewound first, so the
+     *               same source can be reused by consecutive batch commands.
+     * @param shapeClass The shape to detect in the frames.
+     * @param colorId The color class of the shape to detect (see ColorTable).
+     */
+    void BatchMode(FrameSource &source, ShapeClass shapeClass, uchar colorId);
+
+    /**
+     * @brief Parses a query of the form "shape color [top=<n>] [min=<confidence>] [first]".
+     *
+     * The shape may be several words and any alias, in any case. `top=<n>` reports only the n most
+     * confident matches, `min=<confidence>` ignores matches below a confidence in [0, 1], and
+     * `first` stops at the first match that reaches the minimum confidence (see Query). Problems
+     * are reported on standard error.
+     *
+     * @param text The query text, e.g. "Vierkant Geel first min=0.8".
+     * @param query Receives the query.
+     * @return True if the text is a valid query.
+     */
+    static bool parseQuery(const std::string &text, Query &query);
+
+    /**
+     * @brief Checks, without side effects, whether a name denotes one of the predefined shapes.
+     *
+     * @param shape Name or alias of the shape, in any case.
+     * @return True if the shape is known, otherwise false.
+     */
+    static bool isKnownShape(const std::string &shape);
+
+    /**
+     * @brief Checks, without side effects, whether a name denotes a color class of ColorTable::shared().
+     *
+     * @param color Name or alias of the color, in any case.
+     * @return True if the color is known, otherwise false.
+     */
+    static bool isKnownColor(const std::string &color);
 
 private:
     /**
      * @brief Handles user input in interactive mode.
      *
-     * Continuously reads user input from the terminal and updates the detection
-     * criteria based on the input. Supports commands to start/stop detection and
-     * exit the program.
+     * Reads commands from the terminal and the control socket until the mode ends (see
+     * CommandInput) and passes them to handleCommand().
      */
-
     void inputThread();
 
+    /**
+     * @brief Executes one command: a query (see parseQuery()) to publish, "stop" or "exit".
+     *
+     * @param input The command line.
+     */
+    void handleCommand(const std::string &input);
+
     /**
      * @brief Processes the input image to prepare it for shape detection.
      *
-     * Preprocessing includes converting the image to HSV color space, applying a mask
-     * to isolate the color of interest, converting to grayscale, and finally applying
-     * Canny edge detection. The result is used to identify contours that are analyzed
-     * for shape detection.
+     * Preprocessing isolates the pixels that belong to a color class and converts them to
+     * grayscale in one fused, row-tiled pass (see Preprocessor), and finally applies Canny edge
+     * detection. The result is used to identify contours that are analyzed for shape detection.
      */
     void preProcessImage();
 
     /**
-     * @brief Labels a detected shape on the image or terminal based on the operating mode.
-     *
-     * In interactive mode, draws the label directly on the image. In batch mode,
-     * outputs the label information to the terminal. The label includes the shape's name,
-     * color, position, and detection time.
+     * @brief Segments one region of the frame with the selected segmentation and appends its contours.
      *
-     * @param image Reference to the image where the label will be drawn (interactive mode).
-     * @param ID The index of the shape in the `shapesVector`.
+     * @param region The region of `inputImage` to segment.
      */
-    void labelShape(cv::Mat &image, short ID);
+    void segmentRegion(const cv::Rect &region);
 
     /**
-     * @brief Detects triangles in the input image based on contour approximation.
+     * @brief Segments one region by color class (Segmentation::ColorLabels).
      *
-     * This function iterates through detected contours in the input image, approximating each contour to a polygon.
-     * If the approximated polygon has exactly three vertices and passes the convexity and area threshold checks,
-     * it is identified as a triangle. The function then labels the detected triangle based on the specified color.
-     * The computational intensity of this operation depends on the number of contours and the complexity of their shapes.
+     * Labels every pixel in one pass, then extracts the outer contours of every color class and
+     * records the class of each contour in `contourColors`.
      *
-     * @param ColorType The color filter to apply when detecting triangles. Only triangles matching this color are labeled.
+     * @param region The region of `inputImage` to segment.
      */
-    void detectTriangle(std::string ColorType);
+    void segmentColorLabels(const cv::Rect &region);
 
     /**
-     * @fn void Detector::detectSquare(std::string ColorType)
-     * @brief Detects squares in the input image by analyzing contour approximations.
-     *
-     * Similar to triangle detection, this function approximates contours to polygons. A polygon is identified as a square
-     * if it has four vertices and the distances between consecutive vertices are relatively equal (adjustable through a ratio threshold).
-     * This method involves calculating distances between vertices and checking for uniformity to identify squares.
-     * Computational intensity is influenced by contour complexity and the accuracy threshold for square identification.
+     * @brief Copies the contours of the last segmented region into `contours`, backed by `frameArena`.
      *
-     * @param ColorType The color filter to apply when detecting squares. Only squares matching this color are labeled.
+     * @param color The color class of the contours, ColorTable::none if not known yet.
+     */
+    void appendRegionContours(uchar color);
+
+    /**
+     * @brief Finds the full resolution regions around the shapes visible on the coarse pyramid level.
      */
-    void detectSquare(std::string ColorType);
+    void findCandidateRegions();
 
     /**
-     * @fn void Detector::detectRectangle(std::string ColorType)
-     * @brief Detects rectangles by evaluating the aspect ratio and contour approximation.
+     * @brief Reports a detected shape.
      *
-     * This function processes contours similarly to square detection but uses the aspect ratio of the bounding box
-     * of the approximated polygon to distinguish rectangles from squares. Rectangles have an aspect ratio significantly
-     * different from 1. The computational load is comparable to that of square detection, with additional checks for aspect ratio.
+     * Writes a detection record to the result sink, if one is set. Outside batch mode, also
+     * adds a label to the draw list. The label includes the shape's name, color, position,
+     * and detection time.
      *
-     * @param ColorType The color filter to apply when detecting rectangles. Only rectangles matching this color are labeled.
+     * @param ID The index of the shape in `detections`.
      */
-    void detectRectangle(std::string ColorType);
+    void labelShape(size_t ID);
 
     /**
-     * @fn void Detector::detectCircle(std::string ColorType)
-     * @brief Detects circles based on circularity and aspect ratio criteria.
+     * @brief Classifies every contour of the current frame in a single pass.
      *
-     * Circles are detected by approximating contours and calculating each contour's circularity and aspect ratio.
-     * A high circularity value and an aspect ratio close to 1 indicate a circle. Circularity is calculated using the
-     * contour area and perimeter, making this method computationally more intensive due to the need for precise area
-     * and perimeter calculations.
+     * Computes the geometric features and shape class of each contour once, and then the color of
+     * every contour that was labelled with a shape class: the median color of its interior, measured
+     * for all contours in one shared pass (see ColorStatistics), or the color class it was segmented
+     * with. The results are cached in `contourFeatures` and `detections` for answerQuery().
      *
-     * @param ColorType The color filter to apply when detecting circles. Only circles matching this color are labeled.
+     * Contours are independent and every contour only writes its own entry, so frames with many
+     * contours are classified in parallel with cv::parallel_for_. Nothing is drawn here; drawing
+     * and labelling happen afterwards in answerQuery(), serially and in contour order, so the
+     * output does not depend on the thread schedule.
+     *
+     * When every query stops at its first match, the contours are classified in batches of
+     * growing size, in contour order, until every query has a match; the contours after that are
+     * left unclassified.
+     *
+     * @param queries The queries of the frame.
      */
-    void detectCircle(std::string ColorType);
+    void classifyContours(const std::vector<Query> &queries);
 
     /**
-     * @fn void Detector::detectHalfCircle(std::string ColorType)
-     * @brief Detects half-circles by evaluating contour properties and excluding full circles.
+     * @brief Classifies a range of contours and measures the colors of the shapes among them.
      *
-     * Half-circle detection is a more complex process that first identifies potential circles (or partial circles)
-     * based on contour approximation and then filters out full circles by checking the contour's properties, such as
-     * circularity and aspect ratio. Given the additional steps to distinguish half-circles from full circles, this function
-     * can be more computationally intensive than detecting full circles.
+     * @param range The indices of the contours, following those classified before in this frame.
+     */
+    void classifyBatch(const cv::Range &range);
+
+    /**
+     * @brief Checks whether every query has found its first match, given the shapes of the last batch.
      *
-     * @param ColorType The color filter to apply when detecting half-circles. Only half-circles matching this color are labeled.
+     * @param queries The queries of the frame, all stopping at their first match.
+     * @param firstDetection Index in `detections` of the first shape of the last batch.
+     * @return True if every query has a match.
      */
-    void detectHalfCircle(std::string ColorType);
+    bool allQueriesFound(const std::vector<Query> &queries, size_t firstDetection);
 
     /**
-     * @brief Sets the attributes of a detected shape.
+     * @brief Marks and labels the classified contours that answer the query.
+     *
+     * Only reads the cached classification; no contour is measured again. Matches are reported in
+     * contour order, or most confident first when the query limits their number.
      *
-     * Populates the `Shape` object at the specified index in `shapesVector` with the shape's
-     * name, position, detection end time, and whether the shape and color match the criteria.
+     * @param query The shape and color combination to look for, with its options.
+     * @return True if at least one matching shape was found.
+     */
+    bool answerQuery(const Query &query);
+
+    /**
+     * @brief Chooses the region of the current frame to search: the whole frame or the tracked region.
+     */
+    void chooseSearchRect();
+
+    /**
+     * @brief Assigns a matching shape to the closest compatible track of the previous frame, or to a new track.
      *
-     * @param shape Name of the detected shape.
-     * @param position Position of the shape in the image.
-     * @param clocktickEnd CPU tick count at the end of detection.
-     * @param correctShapeAndColor Flag indicating if the detected shape matches the search criteria.
-     * @param ID Index of the shape in the `shapesVector`.
+     * @param ID The index of the shape in `detections`.
+     * @return The ID of the track.
      */
+    int assignTrack(size_t ID);
 
-    void setShape(std::string shape, cv::Point position, long long clocktickEnd, bool correctShapeAndColor, short ID);
+    /**
+     * @brief Drops the tracks that were not seen in the current frame and prepares the rest for the next one.
+     */
+    void updateTracks();
 
     /**
      * @brief Checks if the specified shape is one of the predefined valid shapes.
@@ -187,14 +572,95 @@ private:
      */
     bool isValidColor(std::string color);
 
-    /** Stores detected shapes in the current frame. */
-    std::vector<Shape> shapesVector;
+    /** The shapes classified in the current frame. */
+    DetectionStore detections;
 
     /** Indicates whether the detector is operating in batch mode. */
     bool batchMode = false;
 
-    /** Holds the contours found in the input image for shape detection. */
-    std::vector<std::vector<cv::Point>> contours;
+    /** Where detection records go, nullptr for none. */
+    ResultSink *resultSink = nullptr;
+
+    /** Record reused for every write; its source and frame are set by setFrameOrigin(). */
+    DetectionRecord record;
+
+    /** Tick count (cv::getTickCount) at which processing of the current frame began. */
+    long long frameClocktickBegin = 0;
+
+    /** How frames are segmented into contours. */
+    Segmentation segmentation = Segmentation::Edges;
+
+    /** Color class per pixel of the searched region (Segmentation::ColorLabels). */
+    cv::Mat labelImage;
+
+    /** Pixels of one color class of the searched region (Segmentation::ColorLabels). */
+    cv::Mat labelMask;
+
+    /** Contours of the last segmented region, copied into `contours` afterwards; reused so its vectors keep their capacity. */
+    std::vector<std::vector<cv::Point>> regionContours;
+
+    /** Number of halvings of the coarse pyramid level, 0 when the pyramid is disabled. */
+    int pyramidLevels = 0;
+
+    /** Hysteresis thresholds of the Canny edge detection. */
+    CannyThresholds cannyThresholds = DetectorProfile::shared().getCanny();
+
+    /** The color classes. */
+    const ColorTable *colorTable = &ColorTable::shared();
+
+    /** The searched region at the coarse pyramid level. */
+    cv::Mat pyramidImage;
+
+    /** Full resolution regions around the candidates of the coarse pyramid level. */
+    std::vector<cv::Rect> candidateRegions;
+
+    /** Color class per contour (Segmentation::ColorLabels). */
+    std::vector<uchar> contourColors;
+
+    /** Measures the interior color of the contours (Segmentation::Edges). */
+    ColorStatistics colorStatistics;
+
+    /** Interior color per contour of the current frame (Segmentation::Edges). */
+    std::vector<RegionColor> regionColors;
+
+    /** Holds the contours found in the input image for shape detection; valid until the end of the frame. */
+    ContourList contours;
+
+    /** Storage of the contour points of the current frame, reset at the end of every frame. */
+    FrameArena frameArena;
+
+    /** Usage of `frameArena` in the last frame. */
+    ArenaStats arenaStats;
+
+    /** Contours discarded by each stage of the rejection cascade in the last frame. */
+    RejectStats rejectStats;
+
+    /** Geometric features and shape class of each contour in `contours`. */
+    std::vector<ContourFeatures> contourFeatures;
+
+    /** Tick count (cv::getTickCount) when classifying each contour began. */
+    std::vector<int64> contourClocktickBegins;
+
+    /** Tick count when the geometric classification of each contour ended. */
+    std::vector<int64> contourClocktickEnds;
+
+    /** Labels contours with their shape class. */
+    ShapeClassifier classifier;
+
+    /** Frames with fewer contours are classified serially; also the number of contours per parallel stripe and of the first batch. */
+    static constexpr size_t minParallelContours = 32;
+
+    /** Whether each query of the frame has found its first match (see allQueriesFound()). */
+    std::vector<uchar> foundQueries;
+
+    /** The matches of the query being answered, reused from query to query. */
+    std::vector<size_t> queryMatches;
+
+    /** Produces the color-masked grayscale image in a single pass over the frame. */
+    Preprocessor preprocessor;
+
+    /** The color-masked grayscale image fed to Canny edge detection. */
+    cv::Mat grayImage;
 
     /** The result of applying Canny edge detection to the input image. */
     cv::Mat cannyOutputImage;
@@ -205,6 +671,45 @@ private:
     /** An optional debug image to visualize the effect of Canny edge detection. */
     cv::Mat cannyDebug;
 
+    /** The single query built from `shape` and `color`, reused by detectShapes(cv::Mat &). */
+    std::vector<Query> activeQueries;
+
+    /** Temporal tracking parameters. */
+    TrackingConfig trackingConfig;
+
+    /** Shapes followed from the previous frame. */
+    std::vector<Track> tracks;
+
+    /** ID given to the next new track. */
+    int nextTrackId = 0;
+
+    /** Frames searched only within the tracked region since the last full search. */
+    int framesSinceFullSearch = 0;
+
+    /** Set when a query matched nothing or a track was lost, so the next frame is searched in full. */
+    bool trackingMiss = false;
+
+    /** Region of the current frame that is searched. */
+    cv::Rect searchRect;
+
+    /** Scratch buffer for label and status texts. */
+    std::string labelText;
+
+    /** Number of queries of the last detectShapes() call that matched nothing. */
+    unsigned frameMisses = 0;
+
+    /** Number of heap allocations made during the last detectShapes() call. */
+    unsigned long long frameAllocations = 0;
+
+    /** Stage timings of the last detectShapes() call. */
+    FrameTimings frameTimings;
+
+    /** Whether contours and labels are recorded in `drawList` outside batch mode. */
+    bool annotate = true;
+
+    /** The overlays of the current frame. */
+    DrawList drawList;
+
     /** Flag indicating if the specified shape and color were found in the current frame. */
     bool foundShape = false;
 
@@ -214,14 +719,17 @@ private:
     /** Atomic flag controlling the state of the input handling thread. */
     std::atomic<bool> inputThreadRunning = true;
 
-    /** Atomic flag indicating whether shape detection should be performed in the input thread. */
-    std::atomic<bool> inputThreadDetect = false;
+    /** The queries of interactive mode, published by the input thread and read by detection threads. */
+    QueryChannel queryChannel;
+
+    /** Reads the commands of interactive mode. */
+    CommandInput commandInput;
 
-    /** The name of the shape to detect, as specified by the user. */
-    std::string shape;
+    /** The shape to detect in batch mode. */
+    ShapeClass shape = ShapeClass::None;
 
-    /** The target color for shape detection, as specified by the user. */
-    std::string color;
+    /** The color class ID to detect in batch mode. */
+    uchar color = ColorTable::none;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "detectorProfile.hpp"
+
+DetectorProfile::DetectorProfile()
+{
+}
+
+DetectorProfile::~DetectorProfile()
+{
+}
+
+bool DetectorProfile::load(const std::string &path)
+{
+    cv::FileStorage file;
+    try
+    {
+        file.open(path, cv::FileStorage::READ);
+    }
+    catch (const cv::Exception &exception)
+    {
+        std::cerr << "Error: Could not parse profile " << path << ": " << exception.what() << std::endl;
+        return false;
+    }
+    if (!file.isOpened())
+    {
+        std::cerr << "Error: Could not open profile " << path << std::endl;
+        return false;
+    }
+
+    CannyThresholds loadedCanny = canny;
+    cv::FileNode cannyNode = file["canny"];
+    if (!cannyNode.empty())
+    {
+        loadedCanny.low = static_cast<double>(cannyNode["low"]);
+        loadedCanny.high = static_cast<double>(cannyNode["high"]);
+        if (loadedCanny.low <= 0 || loadedCanny.high < loadedCanny.low)
+        {
+            std::cerr << "Error: canny in " << path << " needs 0 < low <= high" << std::endl;
+            return false;
+        }
+    }
+
+    // The colors entry has the format of a color configuration, so the ColorTable parser reads it.
+    std::vector<ColorClass> loadedColors;
+    if (!file["colors"].empty())
+    {
+        ColorTable table;
+        if (!table.load(path))
+        {
+            return false;
+        }
+        loadedColors = table.getClasses();
+    }
+
+    canny = loadedCanny;
+    colors = loadedColors;
+    return true;
+}
+
+bool DetectorProfile::save(const std::string &path) const
+{
+    cv::FileStorage file;
+    try
+    {
+        file.open(path, cv::FileStorage::WRITE);
+    }
+    catch (const cv::Exception &exception)
+    {
+        std::cerr << "Error: Could not write profile " << path << ": " << exception.what() << std::endl;
+        return false;
+    }
+    if (!file.isOpened())
+    {
+        std::cerr << "Error: Could not write profile " << path << std::endl;
+        return false;
+    }
+
+    file << "canny" << "{" << "low" << canny.low << "high" << canny.high << "}";
+    if (!colors.empty())
+    {
+        file << "colors" << "[";
+        for (const ColorClass &color : colors)
+        {
+            file << "{" << "name" << color.name;
+            if (!color.aliases.empty())
+            {
+                file << "aliases" << "[";
+                for (const std::string &alias : color.aliases)
+                {
+                    file << alias;
+                }
+                file << "]";
+            }
+            file << "lower" << "[" << static_cast<int>(color.lower[0]) << static_cast<int>(color.lower[1]) << static_cast<int>(color.lower[2]) << "]";
+            file << "upper" << "[" << static_cast<int>(color.upper[0]) << static_cast<int>(color.upper[1]) << static_cast<int>(color.upper[2]) << "]" << "}";
+        }
+        file << "]";
+    }
+    file.release();
+    return true;
+}
+
+const CannyThresholds &DetectorProfile::getCanny() const
+{
+    return canny;
+}
+
+void DetectorProfile::setCanny(const CannyThresholds &canny)
+{
+    this->canny = canny;
+}
+
+const std::vector<ColorClass> &DetectorProfile::getColors() const
+{
+    return colors;
+}
+
+void DetectorProfile::setColors(const std::vector<ColorClass> &colors)
+{
+    this->colors = colors;
+}
+
+DetectorProfile &DetectorProfile::shared()
+{
+    static DetectorProfile profile;
+    return profile;
+}
@@ -0,0 +1,89 @@
+#ifndef DETECTORPROFILE_H
+#define DETECTORPROFILE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include "colorTable.hpp"
+
+/**
+ * @struct CannyThresholds
+ * @brief Hysteresis thresholds of the Canny edge detection on the color-masked grayscale image.
+ */
+struct CannyThresholds
+{
+    /** Gradients below this are never edges. */
+    double low = 150.0;
+
+    /** Gradients above this are always edges; weaker ones only when connected to one. */
+    double high = 200.0;
+};
+
+/**
+ * @class DetectorProfile
+ * @brief Tuned detection parameters: the Canny thresholds and, optionally, the color classes.
+ *
+ * A profile is a color configuration (see ColorTable) with an extra `canny` entry, written by
+ * ShapeDetectorTune:
+ *
+ *     %YAML:1.0
+ *     canny: { low: 100, high: 200 }
+ *     colors:
+ *        - { name: roze, aliases: [pink], lower: [108, 110, 54], upper: [170, 255, 255] }
+ *
+ * Both entries are optional; a profile without colors keeps the current color classes.
+ */
+class DetectorProfile
+{
+public:
+    DetectorProfile();
+    virtual ~DetectorProfile();
+
+    /**
+     * @brief Replaces the profile by the one in a YAML or JSON file.
+     *
+     * @param path The profile file.
+     * @return True if the file was read; on failure the current profile is kept.
+     */
+    bool load(const std::string &path);
+
+    /**
+     * @brief Writes the profile to a YAML or JSON file, depending on the extension.
+     *
+     * @param path The profile file.
+     * @return True if the file was written.
+     */
+    bool save(const std::string &path) const;
+
+    /** @return The Canny thresholds. */
+    const CannyThresholds &getCanny() const;
+
+    /** @param canny The Canny thresholds. */
+    void setCanny(const CannyThresholds &canny);
+
+    /** @return The color classes, empty if the profile leaves them as configured. */
+    const std::vector<ColorClass> &getColors() const;
+
+    /** @param colors The color classes, empty to leave them as configured. */
+    void setColors(const std::vector<ColorClass> &colors);
+
+    /**
+     * @brief Returns the process-wide profile; new detectors take their Canny thresholds from it.
+     *
+     * Load the profile, and apply its colors to ColorTable::shared(), before creating detectors.
+     *
+     * @return The shared profile.
+     */
+    static DetectorProfile &shared();
+
+private:
+    /** The Canny thresholds. */
+    CannyThresholds canny;
+
+    /** The color classes, empty if not part of the profile. */
+    std::vector<ColorClass> colors;
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "detectorService.hpp"
+
+#include <iomanip>
+
+DetectorService::DetectorService(const ServiceConfig &config)
+    : config(config)
+{
+}
+
+DetectorService::~DetectorService()
+{
+}
+
+int DetectorService::addStream(const std::string &location)
+{
+    std::unique_ptr<Stream> stream = std::make_unique<Stream>();
+    if (!stream->source.open(location))
+    {
+        return -1;
+    }
+
+    stream->location = location.empty() ? "0" : location;
+    stream->detector.setAnnotate(false);
+    stream->detector.setSegmentation(config.segmentation);
+    stream->detector.setPyramidLevels(config.pyramidLevels);
+    stream->detector.setTracking(config.tracking);
+    stream->detector.setResultSink(resultSink);
+
+    streams.push_back(std::move(stream));
+    return static_cast<int>(streams.size()) - 1;
+}
+
+bool DetectorService::setQueries(int stream, const std::vector<Query> &queries)
+{
+    if (stream < 0 || static_cast<size_t>(stream) >= streams.size())
+    {
+        return false;
+    }
+
+    streams[stream]->queries.publish(queries);
+    return true;
+}
+
+void DetectorService::setResultSink(ResultSink *sink)
+{
+    resultSink = sink;
+    for (std::unique_ptr<Stream> &stream : streams)
+    {
+        stream->detector.setResultSink(sink);
+    }
+}
+
+void DetectorService::run()
+{
+    if (streams.empty())
+    {
+        return;
+    }
+
+    start = std::chrono::steady_clock::now();
+    running = true;
+    activeStreams = streams.size();
+    for (std::unique_ptr<Stream> &stream : streams)
+    {
+        stream->due = start;
+    }
+
+    unsigned workers = config.workers > 0 ? config.workers : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min<unsigned>(workers, static_cast<unsigned>(streams.size()));
+
+    // Every worker runs its frames serially, parallelism comes from the streams.
+    int threads = cv::getNumThreads();
+    if (workers > 1)
+    {
+        cv::setNumThreads(1);
+    }
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; i++)
+    {
+        pool.emplace_back([this]
+                          { worker(); });
+    }
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+
+    cv::setNumThreads(threads);
+    if (resultSink)
+    {
+        resultSink->flush();
+    }
+}
+
+void DetectorService::stop()
+{
+    running = false;
+}
+
+size_t DetectorService::getStreamCount() const
+{
+    return streams.size();
+}
+
+StreamStats DetectorService::getStreamStats(int stream) const
+{
+    if (stream < 0 || static_cast<size_t>(stream) >= streams.size())
+    {
+        return StreamStats();
+    }
+
+    std::lock_guard<std::mutex> lock(streams[stream]->statsMutex);
+    return streams[stream]->stats;
+}
+
+void DetectorService::printStats(std::ostream &out) const
+{
+    out << std::left << std::setw(6) << "id" << std::setw(32) << "source" << std::right << std::setw(10) << "frames"
+        << std::setw(10) << "fps" << std::setw(12) << "detections" << std::setw(10) << "misses" << std::setw(10) << "mean ms"
+        << std::setw(10) << "max ms" << '\n';
+
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        StreamStats stats = getStreamStats(static_cast<int>(i));
+        double fps = stats.elapsedSeconds > 0 ? stats.frames / stats.elapsedSeconds : 0.0;
+        double mean = stats.frames > 0 ? 1000 * stats.busySeconds / stats.frames : 0.0;
+        out << std::left << std::setw(6) << i << std::setw(32) << streams[i]->location << std::right << std::fixed
+            << std::setprecision(0) << std::setw(10) << stats.frames << std::setprecision(1) << std::setw(10) << fps
+            << std::setw(12) << stats.detections << std::setw(10) << stats.misses << std::setprecision(2) << std::setw(10)
+            << mean << std::setw(10) << 1000 * stats.maxFrameSeconds << '\n';
+    }
+    out.flush();
+}
+
+void DetectorService::worker()
+{
+    while (running.load() && activeStreams.load() > 0)
+    {
+        if (config.duration > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= config.duration)
+        {
+            running = false;
+            break;
+        }
+        if (!processNext())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+bool DetectorService::processNext()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    // Each claim advances the shared cursor, so the streams take turns whichever worker asks.
+    for (size_t attempt = 0; attempt < streams.size(); attempt++)
+    {
+        Stream &stream = *streams[cursor.fetch_add(1) % streams.size()];
+        if (stream.ended.load() || stream.busy.exchange(true))
+        {
+            continue;
+        }
+
+        // The due time is written by whichever worker owns the stream, so it is only read once claimed,
+        // and the previous owner may have ended the stream meanwhile.
+        if (stream.ended.load() || now < stream.due)
+        {
+            stream.busy = false;
+            continue;
+        }
+
+        process(stream);
+        stream.busy = false;
+        return true;
+    }
+    return false;
+}
+
+void DetectorService::process(Stream &stream)
+{
+    if (!stream.source.read(stream.frame))
+    {
+        if (!config.loop || stream.source.isLive())
+        {
+            stream.ended = true;
+            activeStreams--;
+            return;
+        }
+        stream.source.rewind();
+        if (!stream.source.read(stream.frame))
+        {
+            stream.ended = true;
+            activeStreams--;
+            return;
+        }
+    }
+
+    if (config.frameRate > 0 && !stream.source.isLive())
+    {
+        // A stream that fell behind resumes at the frame rate instead of catching up in a burst.
+        std::chrono::steady_clock::duration period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / config.frameRate));
+        stream.due = std::max(stream.due + period, std::chrono::steady_clock::now());
+    }
+
+    // A stopped stream or one without queries still consumes its frames, but nothing is looked for.
+    stream.queries.refresh(stream.frameQueries);
+    if (!stream.frameQueries || !stream.frameQueries->active || stream.frameQueries->queries.empty())
+    {
+        return;
+    }
+    stream.detector.setFrameOrigin(stream.location, stream.source.getFrameIndex());
+    stream.detector.detectShapes(stream.frame, stream.frameQueries->queries);
+
+    DetectionStore::Selection matched = stream.detector.getDetections().matched();
+    unsigned long long detections = std::distance(matched.begin(), matched.end());
+    unsigned long long misses = stream.detector.getFrameMisses();
+
+    double seconds = stream.detector.getFrameTimings().total;
+    std::lock_guard<std::mutex> lock(stream.statsMutex);
+    stream.stats.frames++;
+    stream.stats.detections += detections;
+    stream.stats.misses += misses;
+    stream.stats.busySeconds += seconds;
+    stream.stats.maxFrameSeconds = std::max(stream.stats.maxFrameSeconds, seconds);
+    stream.stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,223 @@
+#ifndef DETECTORSERVICE_H
+#define DETECTORSERVICE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <memory>
+
+#include <opencv2/opencv.hpp>
+#include "detector.hpp"
+#include "frameSource.hpp"
+#include "resultSink.hpp"
+
+/**
+ * @struct ServiceConfig
+ * @brief Tunables of a DetectorService.
+ */
+struct ServiceConfig
+{
+    /** Number of worker threads shared by all streams, 0 for one per hardware thread. */
+    unsigned workers = 0;
+
+    /** Segmentation used for every stream. */
+    Segmentation segmentation = Segmentation::Edges;
+
+    /** Coarse pyramid level used for every stream, 0 for none (see Detector::setPyramidLevels). */
+    int pyramidLevels = 0;
+
+    /** Region-of-interest tracking applied to every stream. */
+    TrackingConfig tracking;
+
+    /** Whether file based streams restart at their first frame when they run out, like a camera that never ends. */
+    bool loop = false;
+
+    /** Frames per second at which file based streams are delivered, 0 for as fast as the workers go. */
+    double frameRate = 0.0;
+
+    /** Seconds after which the service stops, 0 to run until every stream has ended. */
+    double duration = 0.0;
+};
+
+/**
+ * @struct StreamStats
+ * @brief Counters of one stream of a DetectorService.
+ */
+struct StreamStats
+{
+    /** Frames detected. */
+    unsigned long long frames = 0;
+
+    /** Shapes that answered a query. */
+    unsigned long long detections = 0;
+
+    /** Queries that matched nothing in a frame. */
+    unsigned long long misses = 0;
+
+    /** Total detection time in seconds. */
+    double busySeconds = 0.0;
+
+    /** Longest detection time of a single frame in seconds. */
+    double maxFrameSeconds = 0.0;
+
+    /** Seconds since the service started. */
+    double elapsedSeconds = 0.0;
+};
+
+/**
+ * @class DetectorService
+ * @brief Runs shape detection on many sources in one process with a shared pool of workers.
+ *
+ * Every stream owns a FrameSource, a Detector with all per-frame state, its own queries and its
+ * counters, so streams never share mutable detection state. A fixed pool of worker threads
+ * serves all streams: a worker takes the next stream in round-robin order that is neither being
+ * processed nor waiting for its next frame, reads one frame and detects it. Every stream thus
+ * gets one frame per round however fast its source delivers, a stream is only ever processed by
+ * one worker at a time so its frames are handled in order, and the pool never holds more threads
+ * than the machine has cores, however many cameras are attached.
+ */
+class DetectorService
+{
+public:
+    explicit DetectorService(const ServiceConfig &config);
+    virtual ~DetectorService();
+
+    /**
+     * @brief Adds a stream; only allowed before run().
+     *
+     * @param location Camera index, image, directory, video file or stream URL (see FrameSource::open).
+     * @return The ID of the stream, or -1 if the source could not be opened.
+     */
+    int addStream(const std::string &location);
+
+    /**
+     * @brief Replaces the queries of a stream; takes effect at its next frame. Safe while running.
+     *
+     * @param stream The ID of the stream.
+     * @param queries The shape and color combinations to look for.
+     * @return False if there is no such stream.
+     */
+    bool setQueries(int stream, const std::vector<Query> &queries);
+
+    /**
+     * @brief Sets where the detection records of all streams are written.
+     *
+     * @param sink The sink, owned by the caller; nullptr for none.
+     */
+    void setResultSink(ResultSink *sink);
+
+    /**
+     * @brief Processes the streams until every stream has ended, the duration has passed or stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Asks run() to return after the frames in progress; safe from any thread.
+     */
+    void stop();
+
+    /** @return The number of streams. */
+    size_t getStreamCount() const;
+
+    /**
+     * @brief Returns a snapshot of the counters of a stream; safe while running.
+     *
+     * @param stream The ID of the stream.
+     * @return The counters, all zero if there is no such stream.
+     */
+    StreamStats getStreamStats(int stream) const;
+
+    /**
+     * @brief Prints one line of counters per stream.
+     *
+     * @param out The stream to print to.
+     */
+    void printStats(std::ostream &out) const;
+
+private:
+    /**
+     * @struct Stream
+     * @brief The state of one source.
+     */
+    struct Stream
+    {
+        /** The location the stream was opened on, as written to records. */
+        std::string location;
+
+        /** The source of the frames. */
+        FrameSource source;
+
+        /** The detector of this stream. */
+        Detector detector;
+
+        /** The current frame. */
+        cv::Mat frame;
+
+        /** The queries, published by setQueries(). */
+        QueryChannel queries;
+
+        /** The queries of the frame being processed. */
+        std::shared_ptr<const QuerySnapshot> frameQueries;
+
+        /** Set while a worker processes the stream. */
+        std::atomic<bool> busy{false};
+
+        /** Set once the source has no more frames. */
+        std::atomic<bool> ended{false};
+
+        /** When the next frame is due, with a frame rate set. */
+        std::chrono::steady_clock::time_point due;
+
+        /** Guards `stats`. */
+        mutable std::mutex statsMutex;
+
+        /** The counters. */
+        StreamStats stats;
+    };
+
+    /**
+     * @brief Worker loop: serves streams in round-robin order until the service stops.
+     */
+    void worker();
+
+    /**
+     * @brief Reads and detects one frame of the next stream that is ready.
+     *
+     * @return False if no stream was ready.
+     */
+    bool processNext();
+
+    /**
+     * @brief Reads and detects one frame of a stream the calling worker has claimed.
+     *
+     * @param stream The stream.
+     */
+    void process(Stream &stream);
+
+    /** The configuration. */
+    ServiceConfig config;
+
+    /** The streams, in ID order. */
+    std::vector<std::unique_ptr<Stream>> streams;
+
+    /** Where records go, nullptr for none. */
+    ResultSink *resultSink = nullptr;
+
+    /** Round-robin position shared by all workers. */
+    std::atomic<size_t> cursor{0};
+
+    /** Number of streams that have not ended. */
+    std::atomic<size_t> activeStreams{0};
+
+    /** Cleared by stop(). */
+    std::atomic<bool> running{false};
+
+    /** When run() started. */
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
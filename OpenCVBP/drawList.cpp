@@ -0,0 +1,152 @@
+#include "drawList.hpp"
+
+DrawList::DrawList()
+{
+}
+
+DrawList::~DrawList()
+{
+}
+
+void DrawList::clear()
+{
+    commands.clear();
+    points.clear();
+    text.clear();
+}
+
+bool DrawList::empty() const
+{
+    return commands.empty();
+}
+
+size_t DrawList::size() const
+{
+    return commands.size();
+}
+
+void DrawList::addOutline(const cv::Point *points, int count, const cv::Scalar &color)
+{
+    DrawCommand command;
+    command.kind = DrawKind::Outline;
+    command.first = this->points.size();
+    command.count = static_cast<size_t>(count);
+    command.color = color;
+    this->points.insert(this->points.end(), points, points + count);
+    commands.push_back(command);
+}
+
+void DrawList::addCircle(cv::Point center, int radius, const cv::Scalar &color)
+{
+    DrawCommand command;
+    command.kind = DrawKind::Circle;
+    command.position = center;
+    command.radius = radius;
+    command.color = color;
+    commands.push_back(command);
+}
+
+void DrawList::addLabel(cv::Point anchor, std::string_view text)
+{
+    DrawCommand command;
+    command.kind = DrawKind::Label;
+    command.position = anchor;
+    command.fontScale = labelScale;
+    command.first = this->text.size();
+    command.count = text.size();
+    command.color = cv::Scalar(0, 0, 0);
+    this->text.append(text);
+    commands.push_back(command);
+}
+
+void DrawList::addText(cv::Point origin, std::string_view text, const cv::Scalar &color, double fontScale)
+{
+    DrawCommand command;
+    command.kind = DrawKind::Text;
+    command.position = origin;
+    command.fontScale = fontScale;
+    command.first = this->text.size();
+    command.count = text.size();
+    command.color = color;
+    this->text.append(text);
+    commands.push_back(command);
+}
+
+void DrawList::render(cv::Mat &image)
+{
+    cv::Rect frameRect(0, 0, image.cols, image.rows);
+
+    // All label boxes go into one mask, and the image is blended with white under it once.
+    labelOrigins.clear();
+    labelBoxes.clear();
+    cv::Rect bounds;
+    for (const DrawCommand &command : commands)
+    {
+        if (command.kind == DrawKind::Label)
+        {
+            cv::Rect box;
+            labelOrigins.push_back(placeLabel(command, image.size(), box));
+            box &= frameRect;
+            labelBoxes.push_back(box);
+            bounds = bounds.empty() ? box : (bounds | box);
+        }
+    }
+    if (!bounds.empty())
+    {
+        layerMask.create(bounds.size(), CV_8UC1);
+        layerMask.setTo(cv::Scalar(0));
+        for (const cv::Rect &box : labelBoxes)
+        {
+            layerMask(box - bounds.tl()).setTo(cv::Scalar(255));
+        }
+        cv::Mat region = image(bounds);
+        region.convertTo(layer, -1, 1 - labelAlpha, 255 * labelAlpha);
+        layer.copyTo(region, layerMask);
+    }
+
+    size_t labelIndex = 0;
+    for (const DrawCommand &command : commands)
+    {
+        switch (command.kind)
+        {
+        case DrawKind::Outline:
+        {
+            const cv::Point *outline = points.data() + command.first;
+            int count = static_cast<int>(command.count);
+            cv::polylines(image, &outline, &count, 1, true, command.color, 2);
+            break;
+        }
+        case DrawKind::Circle:
+            cv::circle(image, command.position, command.radius, command.color, 2);
+            break;
+        case DrawKind::Label:
+            label.assign(textOf(command));
+            cv::putText(image, label, labelOrigins[labelIndex++], labelFont, labelScale, command.color, labelThickness);
+            break;
+        case DrawKind::Text:
+            label.assign(textOf(command));
+            cv::putText(image, label, command.position, cv::FONT_HERSHEY_SIMPLEX, command.fontScale, command.color, 1);
+            break;
+        }
+    }
+}
+
+std::string_view DrawList::textOf(const DrawCommand &command) const
+{
+    return std::string_view(text).substr(command.first, command.count);
+}
+
+cv::Point DrawList::placeLabel(const DrawCommand &command, const cv::Size &imageSize, cv::Rect &box)
+{
+    label.assign(textOf(command));
+    cv::Size textSize = cv::getTextSize(label, labelFont, labelScale, labelThickness, 0);
+    cv::Point origin(command.position.x - textSize.width / 2, command.position.y);
+
+    origin.x = std::max(0, origin.x);
+    origin.y = std::max(0, origin.y);
+    origin.x = std::min(imageSize.width - textSize.width, origin.x);
+    origin.y = std::min(imageSize.height - textSize.height, origin.y);
+
+    box = cv::Rect(origin.x, origin.y - textSize.height, textSize.width + 1, textSize.height + 1);
+    return origin;
+}
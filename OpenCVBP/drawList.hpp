@@ -0,0 +1,173 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @enum DrawKind
+ * @brief What a DrawCommand draws.
+ */
+enum class DrawKind
+{
+    /** A closed polygon through points of the list. */
+    Outline,
+
+    /** A circle. */
+    Circle,
+
+    /** A text centered on a point, on a translucent white box. */
+    Label,
+
+    /** A text starting at a point. */
+    Text
+};
+
+/**
+ * @struct DrawCommand
+ * @brief One overlay of a frame.
+ */
+struct DrawCommand
+{
+    /** What to draw. */
+    DrawKind kind = DrawKind::Outline;
+
+    /** Center of a circle or label, origin of a text. */
+    cv::Point position;
+
+    /** Radius of a circle. */
+    int radius = 0;
+
+    /** Font scale of a text. */
+    double fontScale = 1.0;
+
+    /** First point of an outline in the point list, or first character of a text in the text buffer. */
+    size_t first = 0;
+
+    /** Number of points of an outline, or characters of a text. */
+    size_t count = 0;
+
+    /** Color of the stroke or text. */
+    cv::Scalar color;
+};
+
+/**
+ * @class DrawList
+ * @brief The overlays of one frame, recorded during detection and drawn later by render().
+ *
+ * Detection only appends commands, so it never writes to the frame it is still reading and
+ * drawing can happen on another thread, or not at all when nothing is displayed. Points and
+ * texts are copied into buffers owned by the list, which keep their capacity across clear(),
+ * so a list that is reused frame after frame stops allocating.
+ */
+class DrawList
+{
+public:
+    DrawList();
+    virtual ~DrawList();
+
+    /**
+     * @brief Removes all commands.
+     */
+    void clear();
+
+    /** @return True if there is nothing to draw. */
+    bool empty() const;
+
+    /** @return The number of commands. */
+    size_t size() const;
+
+    /**
+     * @brief Adds a closed polygon.
+     *
+     * @param points The vertices; copied.
+     * @param count Number of vertices.
+     * @param color The stroke color.
+     */
+    void addOutline(const cv::Point *points, int count, const cv::Scalar &color);
+
+    /**
+     * @brief Adds a circle.
+     *
+     * @param center The center.
+     * @param radius The radius.
+     * @param color The stroke color.
+     */
+    void addCircle(cv::Point center, int radius, const cv::Scalar &color);
+
+    /**
+     * @brief Adds a small black text centered on a point, on a translucent white box, kept inside the frame.
+     *
+     * @param anchor The point to center on.
+     * @param text The text; copied.
+     */
+    void addLabel(cv::Point anchor, std::string_view text);
+
+    /**
+     * @brief Adds a text.
+     *
+     * @param origin The bottom-left corner of the text.
+     * @param text The text; copied.
+     * @param color The text color.
+     * @param fontScale The font scale.
+     */
+    void addText(cv::Point origin, std::string_view text, const cv::Scalar &color, double fontScale);
+
+    /**
+     * @brief Draws every command on an image.
+     *
+     * The boxes behind all labels are blended into the image in a single pass over their common
+     * bounding box, instead of once per label; strokes and texts are drawn on top afterwards.
+     *
+     * @param image The 8-bit BGR image the commands were recorded for.
+     */
+    void render(cv::Mat &image);
+
+private:
+    /** @return The text of a command. */
+    std::string_view textOf(const DrawCommand &command) const;
+
+    /**
+     * @brief Places a label inside the image.
+     *
+     * @param command The label.
+     * @param imageSize Size of the image.
+     * @param box Receives the box behind the text.
+     * @return The origin of the text.
+     */
+    cv::Point placeLabel(const DrawCommand &command, const cv::Size &imageSize, cv::Rect &box);
+
+    /** The commands in drawing order. */
+    std::vector<DrawCommand> commands;
+
+    /** The vertices of all outlines. */
+    std::vector<cv::Point> points;
+
+    /** The characters of all texts. */
+    std::string text;
+
+    /** Scratch: the blended label layer and its mask, reused across frames. */
+    cv::Mat layer;
+    cv::Mat layerMask;
+
+    /** Scratch: text origin and box of every label, in command order. */
+    std::vector<cv::Point> labelOrigins;
+    std::vector<cv::Rect> labelBoxes;
+
+    /** Scratch: the text of the command being drawn. */
+    std::string label;
+
+    /** Font, scale and thickness of labels. */
+    static constexpr int labelFont = cv::FONT_HERSHEY_SIMPLEX;
+    static constexpr double labelScale = 0.35;
+    static constexpr int labelThickness = 1;
+
+    /** Opacity of the white box behind labels. */
+    static constexpr double labelAlpha = 0.4;
+};
+
+#endif
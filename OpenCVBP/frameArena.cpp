@@ -0,0 +1,69 @@
+#include "frameArena.hpp"
+
+#include <algorithm>
+
+FrameArena::FrameArena(size_t blockSize)
+    : blockSize(blockSize)
+{
+}
+
+FrameArena::~FrameArena()
+{
+}
+
+void *FrameArena::allocate(size_t bytes, size_t alignment)
+{
+    size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+    if (blocks.empty() || aligned + bytes > blockSizes.back())
+    {
+        grow(bytes + alignment);
+        aligned = (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    stats.allocations++;
+    stats.bytes += aligned + bytes - offset;
+    offset = aligned + bytes;
+    return blocks.back().get() + aligned;
+}
+
+void FrameArena::reset()
+{
+    // Blocks added during the frame are merged, so the next frame of the same size fits in one.
+    if (blocks.size() > 1)
+    {
+        size_t total = 0;
+        for (size_t blockBytes : blockSizes)
+        {
+            total += blockBytes;
+        }
+        blocks.clear();
+        blockSizes.clear();
+        grow(total);
+    }
+
+    offset = 0;
+    stats.allocations = 0;
+    stats.bytes = 0;
+    stats.heapBlocks = 0;
+}
+
+ArenaStats FrameArena::getStats() const
+{
+    return stats;
+}
+
+void FrameArena::grow(size_t bytes)
+{
+    // Blocks double, so a frame much larger than the first block needs only a few.
+    size_t size = std::max(blocks.empty() ? blockSize : 2 * blockSizes.back(), bytes);
+    blocks.emplace_back(new unsigned char[size]);
+    blockSizes.push_back(size);
+    offset = 0;
+
+    stats.capacity = 0;
+    for (size_t blockBytes : blockSizes)
+    {
+        stats.capacity += blockBytes;
+    }
+    stats.heapBlocks++;
+}
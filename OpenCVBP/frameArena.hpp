@@ -0,0 +1,101 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * @struct ArenaStats
+ * @brief Usage of a FrameArena during one frame.
+ */
+struct ArenaStats
+{
+    /** Number of allocations served from the arena. */
+    unsigned long long allocations = 0;
+
+    /** Bytes handed out, including alignment padding. */
+    size_t bytes = 0;
+
+    /** Bytes the arena holds in its blocks. */
+    size_t capacity = 0;
+
+    /** Number of blocks the arena had to take from the heap. */
+    unsigned long long heapBlocks = 0;
+};
+
+/**
+ * @class FrameArena
+ * @brief Monotonic allocator for storage that lives exactly one frame.
+ *
+ * Allocating bumps an offset into the current block; nothing is freed individually. reset()
+ * makes the whole arena available again by rewinding the offset, so releasing a frame's worth
+ * of contours costs the same as releasing one. When a frame needs more than the arena holds,
+ * extra blocks are taken from the heap, and on the next reset they are merged into one block
+ * of the combined size, so a stream settles on a single block and stops touching the heap.
+ *
+ * The arena is not thread safe; allocate on the thread that owns it.
+ */
+class FrameArena
+{
+public:
+    /**
+     * @param blockSize Size in bytes of the first block, allocated on first use.
+     */
+    explicit FrameArena(size_t blockSize = 1 << 16);
+    virtual ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /**
+     * @brief Allocates uninitialized storage that stays valid until the next reset().
+     *
+     * @param bytes Number of bytes.
+     * @param alignment Alignment, a power of two of at most alignof(std::max_align_t).
+     * @return The storage.
+     */
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Allocates uninitialized storage for trivially copyable objects.
+     *
+     * @param count Number of objects.
+     * @return The storage.
+     */
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief Releases everything allocated since the last reset.
+     */
+    void reset();
+
+    /** @return The usage since the last reset. */
+    ArenaStats getStats() const;
+
+private:
+    /** Adds a block of at least `bytes` bytes and makes it current. */
+    void grow(size_t bytes);
+
+    /** Size of the first block. */
+    size_t blockSize;
+
+    /** The blocks, in allocation order; the last one is current. */
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+
+    /** Size of every block. */
+    std::vector<size_t> blockSizes;
+
+    /** Next free byte in the current block. */
+    size_t offset = 0;
+
+    /** Usage since the last reset. */
+    ArenaStats stats;
+};
+
+#endif
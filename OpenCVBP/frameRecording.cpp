@@ -0,0 +1,213 @@
+#include "frameRecording.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+const char recordingMagic[8] = {'S', 'D', 'F', 'R', 'A', 'M', 'E', 'S'};
+const uint32_t recordingVersion = 1;
+}
+
+FrameRecorder::FrameRecorder()
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    if (file.is_open())
+    {
+        close();
+    }
+}
+
+bool FrameRecorder::open(const std::string &path)
+{
+    if (file.is_open())
+    {
+        close();
+    }
+
+    this->path = path;
+    index.clear();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Error: Could not create recording " << path << std::endl;
+        return false;
+    }
+
+    // The header is written again with the frame count and index offset by close().
+    RecordingHeader header = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    offset = sizeof(header);
+    return static_cast<bool>(file);
+}
+
+bool FrameRecorder::write(const cv::Mat &frame)
+{
+    if (!file.is_open() || frame.empty() || frame.depth() != CV_8U)
+    {
+        return false;
+    }
+
+    const cv::Mat *bgr = &frame;
+    if (frame.channels() == 1)
+    {
+        cv::cvtColor(frame, converted, cv::COLOR_GRAY2BGR);
+        bgr = &converted;
+    }
+    else if (frame.channels() == 4)
+    {
+        cv::cvtColor(frame, converted, cv::COLOR_BGRA2BGR);
+        bgr = &converted;
+    }
+    else if (frame.channels() != 3)
+    {
+        std::cerr << "Error: Can only record gray, BGR or BGRA frames" << std::endl;
+        return false;
+    }
+
+    align();
+
+    RecordingIndexEntry entry = {};
+    entry.offset = offset;
+    entry.rows = static_cast<uint32_t>(bgr->rows);
+    entry.cols = static_cast<uint32_t>(bgr->cols);
+    entry.step = static_cast<uint32_t>(bgr->cols * bgr->elemSize());
+
+    // Rows are written one by one, so frames that are views into larger images are stored packed.
+    for (int row = 0; row < bgr->rows; row++)
+    {
+        file.write(reinterpret_cast<const char *>(bgr->ptr(row)), entry.step);
+    }
+    offset += static_cast<uint64_t>(entry.step) * entry.rows;
+
+    if (!file)
+    {
+        std::cerr << "Error: Could not write to recording " << path << std::endl;
+        return false;
+    }
+    index.push_back(entry);
+    return true;
+}
+
+bool FrameRecorder::close()
+{
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    align();
+
+    RecordingHeader header = {};
+    std::memcpy(header.magic, recordingMagic, sizeof(header.magic));
+    header.version = recordingVersion;
+    header.frameCount = static_cast<uint32_t>(index.size());
+    header.indexOffset = offset;
+
+    file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(RecordingIndexEntry));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.close();
+
+    if (!file)
+    {
+        std::cerr << "Error: Could not finish recording " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t FrameRecorder::getFrameCount() const
+{
+    return index.size();
+}
+
+void FrameRecorder::align()
+{
+    static const char zeros[alignment] = {};
+    uint64_t padding = (alignment - offset % alignment) % alignment;
+    file.write(zeros, static_cast<std::streamsize>(padding));
+    offset += padding;
+}
+
+FrameRecording::FrameRecording()
+{
+}
+
+FrameRecording::~FrameRecording()
+{
+}
+
+bool FrameRecording::open(const std::string &path)
+{
+    close();
+    if (!file.open(path))
+    {
+        return false;
+    }
+
+    RecordingHeader header;
+    if (file.size() < sizeof(header))
+    {
+        std::cerr << "Error: " << path << " is not a frame recording" << std::endl;
+        file.close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, recordingMagic, sizeof(header.magic)) != 0 || header.version != recordingVersion ||
+        header.indexOffset % alignof(RecordingIndexEntry) != 0 || header.indexOffset > file.size() ||
+        (file.size() - header.indexOffset) / sizeof(RecordingIndexEntry) < header.frameCount)
+    {
+        std::cerr << "Error: " << path << " is not a complete frame recording" << std::endl;
+        file.close();
+        return false;
+    }
+
+    const RecordingIndexEntry *entries = reinterpret_cast<const RecordingIndexEntry *>(file.data() + header.indexOffset);
+    for (uint32_t i = 0; i < header.frameCount; i++)
+    {
+        const RecordingIndexEntry &entry = entries[i];
+        if (entry.rows == 0 || entry.cols == 0 || entry.step < 3ull * entry.cols || entry.offset > header.indexOffset ||
+            static_cast<uint64_t>(entry.step) * entry.rows > header.indexOffset - entry.offset)
+        {
+            std::cerr << "Error: frame " << i << " of " << path << " lies outside the recording" << std::endl;
+            file.close();
+            return false;
+        }
+    }
+
+    index = entries;
+    frameCount = header.frameCount;
+    return true;
+}
+
+void FrameRecording::close()
+{
+    file.close();
+    index = nullptr;
+    frameCount = 0;
+}
+
+size_t FrameRecording::size() const
+{
+    return frameCount;
+}
+
+cv::Mat FrameRecording::frame(size_t index) const
+{
+    const RecordingIndexEntry &entry = this->index[index];
+    return cv::Mat(static_cast<int>(entry.rows), static_cast<int>(entry.cols), CV_8UC3,
+                   const_cast<char *>(file.data() + entry.offset), entry.step);
+}
+
+bool FrameRecording::isRecordingFile(const std::string &path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".frames";
+}
@@ -0,0 +1,180 @@
+#ifndef FRAMERECORDING_H
+#define FRAMERECORDING_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/opencv.hpp>
+#include "mappedFile.hpp"
+
+/**
+ * @struct RecordingHeader
+ * @brief First 64 bytes of a frame recording (.frames file), little-endian like the rest of it.
+ *
+ * The file holds raw 8-bit BGR frames, each starting at a multiple of 64 bytes so the mapped
+ * pixels are aligned for vectorized code, followed by the index: one RecordingIndexEntry per
+ * frame, in recording order.
+ */
+struct RecordingHeader
+{
+    /** "SDFRAMES". */
+    char magic[8];
+
+    /** Format version, 1. */
+    uint32_t version;
+
+    /** Number of frames, and of index entries. */
+    uint32_t frameCount;
+
+    /** Offset of the index from the start of the file. */
+    uint64_t indexOffset;
+
+    /** Zero. */
+    uint64_t reserved[5];
+};
+
+/**
+ * @struct RecordingIndexEntry
+ * @brief Where and how one frame of a recording is stored.
+ */
+struct RecordingIndexEntry
+{
+    /** Offset of the first pixel from the start of the file. */
+    uint64_t offset;
+
+    /** Height of the frame. */
+    uint32_t rows;
+
+    /** Width of the frame. */
+    uint32_t cols;
+
+    /** Bytes from the start of one row to the next. */
+    uint32_t step;
+
+    /** Zero. */
+    uint32_t reserved;
+};
+
+/**
+ * @class FrameRecorder
+ * @brief Writes frames from any source into a frame recording for decode-free, reproducible replay.
+ */
+class FrameRecorder
+{
+public:
+    FrameRecorder();
+    virtual ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder &) = delete;
+    FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+    /**
+     * @brief Creates a recording, replacing an existing file.
+     *
+     * @param path The file to write, by convention with the extension ".frames".
+     * @return True if the file was created.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Appends a frame.
+     *
+     * @param frame An 8-bit BGR frame; 8-bit gray and BGRA frames are converted to BGR.
+     * @return True if the frame was written.
+     */
+    bool write(const cv::Mat &frame);
+
+    /**
+     * @brief Writes the index and closes the file; the recording is only readable afterwards.
+     *
+     * @return True if the recording is complete.
+     */
+    bool close();
+
+    /** @return The number of frames written. */
+    size_t getFrameCount() const;
+
+private:
+    /** Pads the file with zeros up to the next multiple of `alignment`. */
+    void align();
+
+    /** The file being written. */
+    std::ofstream file;
+
+    /** The path of the file, for messages. */
+    std::string path;
+
+    /** Index entries of the frames written so far. */
+    std::vector<RecordingIndexEntry> index;
+
+    /** Current size of the file. */
+    uint64_t offset = 0;
+
+    /** Conversion buffer for frames that are not BGR. */
+    cv::Mat converted;
+
+    /** Alignment of every frame in the file. */
+    static constexpr uint64_t alignment = 64;
+};
+
+/**
+ * @class FrameRecording
+ * @brief Zero-copy reader of a frame recording.
+ *
+ * The file is memory mapped and every frame is returned as a cv::Mat header pointing straight
+ * into the mapping: reading a frame neither decodes nor copies, and the kernel pages the pixels
+ * in on first access. The frames are read-only and stay valid until close().
+ */
+class FrameRecording
+{
+public:
+    FrameRecording();
+    virtual ~FrameRecording();
+
+    /**
+     * @brief Maps and validates a recording written by FrameRecorder.
+     *
+     * @param path The recording.
+     * @return True if the recording is valid.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the recording; frames returned before are invalid afterwards.
+     */
+    void close();
+
+    /** @return The number of frames. */
+    size_t size() const;
+
+    /**
+     * @brief Returns a frame without copying it.
+     *
+     * @param index Index of the frame, less than size().
+     * @return A read-only 8-bit BGR header into the mapping.
+     */
+    cv::Mat frame(size_t index) const;
+
+    /**
+     * @brief Checks whether a path has the extension of a frame recording.
+     *
+     * @param path The path to check.
+     * @return True for ".frames".
+     */
+    static bool isRecordingFile(const std::string &path);
+
+private:
+    /** The mapped file. */
+    MappedFile file;
+
+    /** The index of the mapped file, empty if none is open. */
+    const RecordingIndexEntry *index = nullptr;
+
+    /** Number of entries in `index`. */
+    size_t frameCount = 0;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "frameSource.hpp"
+
+FrameSource::FrameSource()
+{
+}
+
+FrameSource::~FrameSource()
+{
+    close();
+}
+
+bool FrameSource::open(const std::string &location)
+{
+    close();
+    this->location = location;
+
+    // The non-throwing overloads are used throughout, so a bad location fails the open instead of the process.
+    std::error_code error;
+    if (location.empty() || std::all_of(location.begin(), location.end(), [](unsigned char c)
+                                        { return std::isdigit(c) != 0; }))
+    {
+        kind = Kind::Camera;
+        int index = 0;
+        bool valid = location.empty() || std::from_chars(location.data(), location.data() + location.size(), index).ec == std::errc();
+        opened = valid && capture.open(index, cv::CAP_ANY);
+    }
+    else if (std::filesystem::is_directory(location, error))
+    {
+        kind = Kind::Directory;
+        std::filesystem::directory_iterator entry(location, error);
+        for (; !error && entry != std::filesystem::directory_iterator(); entry.increment(error))
+        {
+            std::error_code fileError;
+            if (entry->is_regular_file(fileError) && isImageFile(entry->path()))
+            {
+                files.push_back(entry->path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        opened = !error && !files.empty();
+    }
+    else if (FrameRecording::isRecordingFile(location))
+    {
+        kind = Kind::Recording;
+        opened = recording.open(location);
+    }
+    else if (isImageFile(location))
+    {
+        kind = Kind::Image;
+        files.push_back(location);
+        opened = std::filesystem::is_regular_file(location, error);
+    }
+    else
+    {
+        kind = Kind::Video;
+        opened = capture.open(location, cv::CAP_ANY);
+    }
+
+    if (!opened)
+    {
+        std::cerr << "Error: Could not open source " << (location.empty() ? "0" : location) << std::endl;
+    }
+    return opened;
+}
+
+bool FrameSource::read(cv::Mat &frame)
+{
+    if (!opened)
+    {
+        return false;
+    }
+
+    if (kind == Kind::Camera || kind == Kind::Video)
+    {
+        if (!capture.read(frame) || frame.empty())
+        {
+            return false;
+        }
+        frameIndex++;
+        return true;
+    }
+
+    if (kind == Kind::Recording)
+    {
+        if (fileIndex >= recording.size())
+        {
+            return false;
+        }
+        frame = recording.frame(fileIndex++);
+        frameIndex++;
+        return true;
+    }
+
+    while (fileIndex < files.size())
+    {
+        frame = cv::imread(files[fileIndex++], cv::IMREAD_COLOR);
+        if (!frame.empty())
+        {
+            frameIndex++;
+            return true;
+        }
+        std::cerr << "Error: Could not read image " << files[fileIndex - 1] << std::endl;
+    }
+    return false;
+}
+
+void FrameSource::rewind()
+{
+    if (kind == Kind::Video)
+    {
+        capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+    }
+    fileIndex = 0;
+    if (kind != Kind::Camera)
+    {
+        frameIndex = -1;
+    }
+}
+
+void FrameSource::close()
+{
+    if (capture.isOpened())
+    {
+        capture.release();
+    }
+    files.clear();
+    recording.close();
+    fileIndex = 0;
+    frameIndex = -1;
+    opened = false;
+}
+
+bool FrameSource::isOpened() const
+{
+    return opened;
+}
+
+bool FrameSource::isLive() const
+{
+    return kind == Kind::Camera;
+}
+
+bool FrameSource::isReadOnly() const
+{
+    return kind == Kind::Recording;
+}
+
+FrameSource::Kind FrameSource::getKind() const
+{
+    return kind;
+}
+
+const std::string &FrameSource::getLocation() const
+{
+    return location;
+}
+
+long long FrameSource::getFrameIndex() const
+{
+    return frameIndex;
+}
+
+bool FrameSource::isImageFile(const std::filesystem::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" ||
+           extension == ".tif" || extension == ".tiff" || extension == ".ppm" || extension == ".pgm" ||
+           extension == ".webp";
+}
@@ -0,0 +1,119 @@
+#ifndef FRAMESOURCE_H
+#define FRAMESOURCE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+
+#include <opencv2/opencv.hpp>
+#include "frameRecording.hpp"
+
+/**
+ * @class FrameSource
+ * @brief Uniform, reusable access to the frames of a camera, image, directory, video file or frame recording.
+ *
+ * A FrameSource is opened once and can then be read from (and rewound) as often as needed,
+ * so batch commands that target the same input do not reopen the device or file for every line.
+ */
+class FrameSource
+{
+public:
+    /** The kind of input a source was opened on. */
+    enum class Kind
+    {
+        Camera,
+        Image,
+        Directory,
+        Video,
+        Recording
+    };
+
+    FrameSource();
+    virtual ~FrameSource();
+
+    /**
+     * @brief Opens the given location as a frame source.
+     *
+     * An empty location or a plain device number (e.g. "0") opens a camera. A directory is
+     * expanded to the sorted list of image files it contains, a ".frames" file is replayed as a
+     * frame recording (see FrameRecording), a file with an image extension is read as a single
+     * still, and anything else is handed to cv::VideoCapture as a video file.
+     *
+     * @param location Path of the image, directory or video file, or a camera index.
+     * @return True if the source could be opened, otherwise false.
+     */
+    bool open(const std::string &location);
+
+    /**
+     * @brief Reads the next frame from the source.
+     *
+     * Cameras always deliver a fresh frame. File based sources return false once every frame
+     * has been delivered, until rewind() is called. Frames of a recording are read-only views
+     * into the mapped file (see isReadOnly()), valid until the source is closed.
+     *
+     * @param frame Receives the next frame.
+     * @return True if a frame was read, otherwise false.
+     */
+    bool read(cv::Mat &frame);
+
+    /**
+     * @brief Restarts a file based source at its first frame. Has no effect on cameras.
+     */
+    void rewind();
+
+    /**
+     * @brief Releases the underlying capture and forgets the file list.
+     */
+    void close();
+
+    bool isOpened() const;
+    bool isLive() const;
+
+    /** @return True if read() returns frames that must not be drawn on, i.e. for recordings. */
+    bool isReadOnly() const;
+
+    Kind getKind() const;
+    const std::string &getLocation() const;
+
+    /** @return The index of the frame most recently returned by read(), starting at 0. */
+    long long getFrameIndex() const;
+
+private:
+    /**
+     * @brief Checks whether a path has one of the image extensions understood by cv::imread.
+     *
+     * @param path The path to check.
+     * @return True if the extension denotes a still image.
+     */
+    static bool isImageFile(const std::filesystem::path &path);
+
+    /** The location this source was opened on. */
+    std::string location;
+
+    /** The kind of input behind this source. */
+    Kind kind = Kind::Camera;
+
+    /** Capture used for camera and video sources. */
+    cv::VideoCapture capture;
+
+    /** The image files of an image or directory source, in read order. */
+    std::vector<std::string> files;
+
+    /** The frames of a recording source. */
+    FrameRecording recording;
+
+    /** Index of the next file to read for image and directory sources, or of the next frame of a recording. */
+    size_t fileIndex = 0;
+
+    /** Index of the frame most recently returned by read(). */
+    long long frameIndex = -1;
+
+    /** Flag indicating whether the source was opened successfully. */
+    bool opened = false;
+};
+
+#endif
@@ -1,20 +1,323 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <filesystem>
+#include <stdexcept>
 #include "detector.hpp"
 #include "batchParser.hpp"
+#include "pipeline.hpp"
+#include "detectorService.hpp"
+#include "resultSink.hpp"
 
 int main(int argc, char **argv)
 {
-    if (argc > 1)
+    // The color classes come from colors.yml in the working directory, if present, unless
+    // --color-config names another file; otherwise the built-in classes are used. A tuned
+    // profile (profile.yml or --profile) then sets the Canny thresholds and may replace the colors.
+    std::string colorConfig = "colors.yml";
+    bool colorConfigGiven = false;
+    std::string profile = "profile.yml";
+    bool profileGiven = false;
+    for (int i = 1; i + 1 < argc; i++)
     {
+        if (std::string(argv[i]) == "--color-config")
+        {
+            colorConfig = argv[i + 1];
+            colorConfigGiven = true;
+        }
+        else if (std::string(argv[i]) == "--profile")
+        {
+            profile = argv[i + 1];
+            profileGiven = true;
+        }
+    }
+    if ((colorConfigGiven || std::filesystem::exists(colorConfig)) && !ColorTable::shared().load(colorConfig))
+    {
+        return 1;
+    }
+    if (profileGiven || std::filesystem::exists(profile))
+    {
+        if (!DetectorProfile::shared().load(profile))
+        {
+            return 1;
+        }
+        if (!DetectorProfile::shared().getColors().empty())
+        {
+            ColorTable::shared().setClasses(DetectorProfile::shared().getColors());
+        }
+    }
+
+    if (argc > 1 && std::string(argv[1]).rfind("--", 0) != 0)
+    {
+        std::string format = "csv";
+        std::string output;
+        for (int i = 2; i < argc; i += 2)
+        {
+            std::string option = argv[i];
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Missing value for option " << option << std::endl;
+                return 1;
+            }
+            if (option == "--format")
+                format = argv[i + 1];
+            else if (option == "--output")
+                output = argv[i + 1];
+            else if (option == "--color-config" || option == "--profile")
+                continue;
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                return 1;
+            }
+        }
+
+        std::unique_ptr<ResultSink> sink = ResultSink::create(format, output);
+        if (!sink)
+        {
+            return 1;
+        }
+
         BatchParser batchParser;
-        std::string batchFile = argv[1];
-        batchParser.processBatchFile("batch.txt");
+        return batchParser.processBatchFile(argv[1], *sink) ? 0 : 1;
+    }
+
+    Detector detector;
+    PipelineConfig config;
+    std::string source;
+    std::string tracePath;
+
+    // With one or more --stream options the sources are served headless by a DetectorService.
+    ServiceConfig serviceConfig;
+    std::vector<std::string> streams;
+    std::vector<Query> queries;
+    std::string format = "csv";
+    std::string output;
+
+    // With --record the source is written to a frame recording instead of being detected.
+    std::string recordPath;
+    long long recordFrames = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (option == "--headless")
+        {
+            config.display = false;
+            continue;
+        }
+        if (value.empty())
+        {
+            std::cerr << "Missing value for option " << option << std::endl;
+            return 1;
+        }
+        i++;
+
+        // Numeric values are parsed with std::stoi and friends, which throw on malformed input.
+        try
+        {
+            if (option == "--source")
+            {
+                source = value;
+            }
+            else if (option == "--workers")
+            {
+                config.detectWorkers = std::max(1, std::stoi(value));
+                serviceConfig.workers = config.detectWorkers;
+            }
+            else if (option == "--stream")
+            {
+                streams.push_back(value);
+            }
+            else if (option == "--loop")
+            {
+                serviceConfig.loop = value == "1" || value == "on";
+            }
+            else if (option == "--fps")
+            {
+                serviceConfig.frameRate = std::stod(value);
+            }
+            else if (option == "--duration")
+            {
+                serviceConfig.duration = std::stod(value);
+            }
+            else if (option == "--format")
+            {
+                format = value;
+            }
+            else if (option == "--output")
+            {
+                output = value;
+            }
+            else if (option == "--queue")
+            {
+                config.queueCapacity = std::max(1, std::stoi(value));
+            }
+            else if (option == "--drop")
+            {
+                if (value == "oldest")
+                    config.dropPolicy = DropPolicy::DropOldest;
+                else if (value == "newest")
+                    config.dropPolicy = DropPolicy::DropNewest;
+                else if (value == "block")
+                    config.dropPolicy = DropPolicy::Block;
+                else
+                {
+                    std::cerr << "Invalid drop policy: " << value << std::endl;
+                    return 1;
+                }
+            }
+            else if (option == "--color-config" || option == "--profile")
+            {
+                continue;
+            }
+            else if (option == "--segmentation")
+            {
+                if (value == "edges")
+                    config.segmentation = Segmentation::Edges;
+                else if (value == "labels")
+                    config.segmentation = Segmentation::ColorLabels;
+                else
+                {
+                    std::cerr << "Invalid segmentation: " << value << std::endl;
+                    return 1;
+                }
+            }
+            else if (option == "--pyramid")
+            {
+                config.pyramidLevels = std::stoi(value);
+            }
+            else if (option == "--track")
+            {
+                config.tracking.enabled = true;
+                config.tracking.fullSearchInterval = std::max(1, std::stoi(value));
+            }
+            else if (option == "--trace")
+            {
+                tracePath = value;
+            }
+            else if (option == "--trace-summary")
+            {
+                Trace::setSummaryInterval(std::stod(value));
+            }
+            else if (option == "--record")
+            {
+                recordPath = value;
+            }
+            else if (option == "--record-frames")
+            {
+                recordFrames = std::max(0LL, std::stoll(value));
+            }
+            else if (option == "--control")
+            {
+                if (!detector.openControlSocket(value))
+                {
+                    return 1;
+                }
+            }
+            else if (option == "--query")
+            {
+                Query query;
+                if (!Detector::parseQuery(value, query))
+                {
+                    return 1;
+                }
+                queries.push_back(query);
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::logic_error &)
+        {
+            std::cerr << "Invalid value for option " << option << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    // Tracking follows shapes from one frame to the next, and the workers of the interactive pipeline
+    // each see only every n-th frame and number their tracks independently. The streams of the
+    // service are each detected by one worker at a time, in order, so there it is fine.
+    if (config.tracking.enabled && config.detectWorkers > 1 && streams.empty())
+    {
+        std::cerr << "--track needs a single detection worker, drop --workers or use --workers 1" << std::endl;
+        return 1;
+    }
+
+    if (!Trace::isEnabled() && !tracePath.empty())
+    {
+        std::cerr << "Warning: tracing is not compiled in, rebuild with make TRACE=1" << std::endl;
+    }
+
+    if (!recordPath.empty())
+    {
+        FrameSource frames;
+        FrameRecorder recorder;
+        if (!frames.open(source) || !recorder.open(recordPath))
+        {
+            return 1;
+        }
+
+        // A camera never runs out, so it is recorded for 300 frames unless told otherwise.
+        long long limit = recordFrames > 0 ? recordFrames : (frames.isLive() ? 300 : 0);
+        cv::Mat frame;
+        while ((limit == 0 || static_cast<long long>(recorder.getFrameCount()) < limit) && frames.read(frame))
+        {
+            if (!recorder.write(frame))
+            {
+                return 1;
+            }
+        }
+        if (!recorder.close())
+        {
+            return 1;
+        }
+        std::cout << "Recorded " << recorder.getFrameCount() << " frames to " << recordPath << std::endl;
+    }
+    else if (!streams.empty())
+    {
+        serviceConfig.segmentation = config.segmentation;
+        serviceConfig.pyramidLevels = config.pyramidLevels;
+        serviceConfig.tracking = config.tracking;
+
+        DetectorService service(serviceConfig);
+        for (const std::string &location : streams)
+        {
+            int stream = service.addStream(location);
+            if (stream < 0)
+            {
+                return 1;
+            }
+            service.setQueries(stream, queries);
+        }
+
+        // Without --output the records go to stdout as in batch mode, and the statistics to stderr.
+        std::unique_ptr<ResultSink> sink = ResultSink::create(format, output);
+        if (!sink)
+        {
+            return 1;
+        }
+        service.setResultSink(sink.get());
+
+        service.run();
+        service.printStats(output.empty() ? std::cerr : std::cout);
     }
     else
     {
-        Detector detector;
-        detector.InteractiveMode();
+        // Every --query is looked for, not only the last one.
+        if (!queries.empty())
+        {
+            detector.setQueries(queries);
+        }
+        detector.InteractiveMode(source, config);
+    }
+
+    if (Trace::isEnabled() && !tracePath.empty())
+    {
+        Trace::exportChromeTrace(tracePath);
     }
     return 0;
 }
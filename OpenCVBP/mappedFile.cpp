@@ -0,0 +1,74 @@
+#include "mappedFile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        std::cerr << "Error: Could not open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0)
+    {
+        std::cerr << "Error: Could not stat " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(descriptor);
+        return false;
+    }
+
+    if (status.st_size > 0)
+    {
+        void *address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED)
+        {
+            std::cerr << "Error: Could not map " << path << ": " << std::strerror(errno) << std::endl;
+            ::close(descriptor);
+            return false;
+        }
+        mapping = address;
+        length = static_cast<size_t>(status.st_size);
+        madvise(mapping, length, MADV_SEQUENTIAL);
+    }
+
+    ::close(descriptor);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapping)
+    {
+        munmap(mapping, length);
+    }
+    mapping = nullptr;
+    length = 0;
+}
+
+const char *MappedFile::data() const
+{
+    return static_cast<const char *>(mapping);
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
@@ -0,0 +1,50 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <iostream>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The file contents are paged in by the kernel on first access instead of being copied through
+ * stream buffers, so large files are read without allocation and at the speed of the page cache.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    virtual ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Maps a file, unmapping the previous one.
+     *
+     * @param path The file to map.
+     * @return True if the file was mapped; an empty file maps successfully with size 0.
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @brief Unmaps the file; data() is invalid afterwards.
+     */
+    void close();
+
+    /** @return The first byte of the file, nullptr if nothing or an empty file is mapped. */
+    const char *data() const;
+
+    /** @return The size of the file in bytes. */
+    size_t size() const;
+
+private:
+    /** Start of the mapping. */
+    void *mapping = nullptr;
+
+    /** Length of the mapping. */
+    size_t length = 0;
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "pipeline.hpp"
+
+Pipeline::Pipeline(const PipelineConfig &config)
+    : config(config),
+      detectQueue(config.queueCapacity),
+      renderQueue(config.queueCapacity),
+      recycleQueue(2 * config.queueCapacity + config.detectWorkers + 2)
+{
+}
+
+Pipeline::~Pipeline()
+{
+}
+
+void Pipeline::run(FrameSource &source, Detector &controller)
+{
+    captureDone = false;
+    workersDone = 0;
+
+    std::vector<std::unique_ptr<Detector>> detectors;
+    std::vector<std::thread> workers;
+    unsigned workerCount = std::max(1u, config.detectWorkers);
+
+    for (unsigned i = 0; i < workerCount; i++)
+    {
+        detectors.push_back(std::make_unique<Detector>());
+        detectors.back()->setSegmentation(config.segmentation);
+        detectors.back()->setPyramidLevels(config.pyramidLevels);
+        detectors.back()->setTracking(config.tracking);
+        detectors.back()->setAnnotate(config.display);
+    }
+
+    std::thread captureThread([this, &source, &controller]
+                              { this->captureStage(source, controller); });
+    for (unsigned i = 0; i < workerCount; i++)
+    {
+        Detector &detector = *detectors[i];
+        workers.emplace_back([this, &detector, &controller]
+                             { this->detectStage(detector, controller); });
+    }
+
+    renderStage(controller);
+
+    captureThread.join();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+const PipelineStats &Pipeline::getStats() const
+{
+    return stats;
+}
+
+void Pipeline::captureStage(FrameSource &source, Detector &controller)
+{
+    long long nextId = 0;
+
+    // Recorded frames are read-only views; they are only copied when they will be drawn on.
+    bool copyFrames = source.isReadOnly() && config.display;
+    cv::Mat view;
+
+    while (controller.isRunning())
+    {
+        PipelineFrame frame;
+        recycleQueue.tryPop(frame);
+
+        bool captured;
+        {
+            TRACE_SCOPE("pipeline.capture");
+            if (copyFrames)
+            {
+                captured = source.read(view);
+                if (captured)
+                {
+                    view.copyTo(frame.image);
+                }
+            }
+            else
+            {
+                captured = source.read(frame.image);
+            }
+        }
+        if (!captured)
+        {
+            if (source.isLive())
+            {
+                std::cerr << "Failed to capture image from webcam." << std::endl;
+            }
+            break;
+        }
+
+        frame.id = nextId++;
+        frame.detected = false;
+        stats.captured++;
+        forward(detectQueue, frame, controller);
+    }
+
+    captureDone = true;
+}
+
+void Pipeline::detectStage(Detector &detector, Detector &controller)
+{
+    std::shared_ptr<const QuerySnapshot> queries;
+
+    while (controller.isRunning())
+    {
+        PipelineFrame frame;
+        if (!detectQueue.tryPop(frame))
+        {
+            if (captureDone && detectQueue.size() == 0)
+            {
+                break;
+            }
+            idle();
+            continue;
+        }
+
+        frame.detected = controller.snapshotQueries(queries);
+        if (frame.detected)
+        {
+            detector.detectShapes(frame.image, queries->queries);
+            detector.swapDrawList(frame.overlay);
+            stats.detected++;
+        }
+        else
+        {
+            frame.overlay.clear();
+        }
+
+        forward(renderQueue, frame, controller);
+    }
+
+    workersDone++;
+}
+
+void Pipeline::renderStage(Detector &controller)
+{
+    long long lastRendered = -1;
+    unsigned workerCount = std::max(1u, config.detectWorkers);
+    cv::Mat displayFrame;
+
+    while (controller.isRunning())
+    {
+        PipelineFrame frame;
+        if (!renderQueue.tryPop(frame))
+        {
+            if (workersDone == workerCount && renderQueue.size() == 0)
+            {
+                break;
+            }
+            if (!config.display)
+            {
+                idle();
+            }
+            else if (cv::waitKey(1) >= 0)
+            {
+                controller.stop();
+            }
+            continue;
+        }
+
+        if (frame.id < lastRendered)
+        {
+            stats.dropped++;
+            recycle(frame);
+            continue;
+        }
+        lastRendered = frame.id;
+        stats.rendered++;
+
+        if (config.display)
+        {
+            TRACE_SCOPE("render.display");
+            frame.overlay.render(frame.image);
+            if (!frame.detected)
+            {
+                std::string message = "Detection is not active";
+                double fontScale = 1.5;
+                unsigned short thickness = 2;
+                cv::putText(frame.image, message, cv::Point(30, 50), cv::FONT_HERSHEY_SIMPLEX, fontScale, cv::Scalar(0, 0, 255), thickness);
+            }
+
+            cv::resize(frame.image, displayFrame, cv::Size(), config.displayScale, config.displayScale);
+            cv::imshow("Webcam", displayFrame);
+
+            if (cv::waitKey(1) >= 0)
+            {
+                controller.stop();
+            }
+        }
+
+        recycle(frame);
+    }
+
+    if (config.display)
+    {
+        cv::destroyAllWindows();
+    }
+}
+
+void Pipeline::forward(BoundedQueue<PipelineFrame> &queue, PipelineFrame &frame, Detector &controller)
+{
+    while (!queue.tryPush(frame))
+    {
+        if (config.dropPolicy == DropPolicy::DropOldest)
+        {
+            PipelineFrame oldest;
+            if (queue.tryPop(oldest))
+            {
+                stats.dropped++;
+                recycle(oldest);
+            }
+        }
+        else if (config.dropPolicy == DropPolicy::DropNewest)
+        {
+            stats.dropped++;
+            recycle(frame);
+            return;
+        }
+        else
+        {
+            if (!controller.isRunning())
+            {
+                return;
+            }
+            idle();
+        }
+    }
+}
+
+void Pipeline::recycle(PipelineFrame &frame)
+{
+    recycleQueue.tryPush(frame);
+}
+
+void Pipeline::idle()
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+}
@@ -0,0 +1,188 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+
+#include <opencv2/opencv.hpp>
+#include "boundedQueue.hpp"
+#include "frameSource.hpp"
+#include "detector.hpp"
+
+/**
+ * @brief What a pipeline stage does when the queue to the next stage is full.
+ */
+enum class DropPolicy
+{
+    /** Evict the oldest queued frame, so the next stage always gets the freshest one. */
+    DropOldest,
+    /** Discard the frame that did not fit. */
+    DropNewest,
+    /** Wait until the next stage has made room; no frame is ever dropped. */
+    Block
+};
+
+/**
+ * @struct PipelineConfig
+ * @brief Tunables of the capture -> detect -> render pipeline.
+ */
+struct PipelineConfig
+{
+    /** Capacity of each queue between two stages. */
+    size_t queueCapacity = 2;
+
+    /** Policy applied when a queue is full. */
+    DropPolicy dropPolicy = DropPolicy::DropOldest;
+
+    /** Number of detection threads, each with its own Detector. */
+    unsigned detectWorkers = 1;
+
+    /** Whether rendered frames are shown in a window; when false frames are only counted. */
+    bool display = true;
+
+    /** Scale factor applied to frames before they are shown. */
+    double displayScale = 0.75;
+
+    /** Segmentation used by every detection thread. */
+    Segmentation segmentation = Segmentation::Edges;
+
+    /** Coarse pyramid level used by every detection thread, 0 for none (see Detector::setPyramidLevels). */
+    int pyramidLevels = 0;
+
+    /** Region-of-interest tracking applied by every detection thread. */
+    TrackingConfig tracking;
+};
+
+/**
+ * @struct PipelineFrame
+ * @brief A frame travelling through the pipeline.
+ */
+struct PipelineFrame
+{
+    /** Capture order of the frame, starting at 0. */
+    long long id = -1;
+
+    /** The frame itself; only the render stage draws on it. */
+    cv::Mat image;
+
+    /** Overlays recorded by detection, drawn by the render stage when the frame is displayed. */
+    DrawList overlay;
+
+    /** Whether detection ran on this frame. */
+    bool detected = false;
+};
+
+/**
+ * @struct PipelineStats
+ * @brief Frame counters of a pipeline run.
+ */
+struct PipelineStats
+{
+    std::atomic<unsigned long long> captured{0};
+    std::atomic<unsigned long long> dropped{0};
+    std::atomic<unsigned long long> detected{0};
+    std::atomic<unsigned long long> rendered{0};
+};
+
+/**
+ * @class Pipeline
+ * @brief Runs capture, detection and rendering as separate stages connected by bounded lock-free queues.
+ *
+ * A capture thread reads frames from a FrameSource, one or more detection threads (each owning
+ * its own Detector) classify them, and the calling thread renders them, since HighGUI must be
+ * driven from a single thread. Detection only records its overlays in the frame's DrawList; the
+ * render stage draws them while the detection threads move on to the next frames, and without a
+ * display no overlays are recorded or drawn at all. Full queues are handled according to the configured DropPolicy;
+ * with the default drop-oldest policy detection always works on the freshest frame instead of
+ * falling behind the camera. Frames that leave the pipeline are recycled to the capture stage so
+ * their buffers are reused.
+ */
+class Pipeline
+{
+public:
+    explicit Pipeline(const PipelineConfig &config);
+    virtual ~Pipeline();
+
+    /**
+     * @brief Runs the pipeline until the source is exhausted, a key is pressed or the controller stops.
+     *
+     * @param source The opened source to read frames from.
+     * @param controller The interactive detector that owns the current query and the running state.
+     *                   Workers pick up its query at every frame boundary.
+     */
+    void run(FrameSource &source, Detector &controller);
+
+    /** @return The frame counters of the last run. */
+    const PipelineStats &getStats() const;
+
+private:
+    /**
+     * @brief Capture stage: reads frames from the source into the detection queue.
+     *
+     * @param source The source to read from.
+     * @param controller The detector whose running state ends the stage.
+     */
+    void captureStage(FrameSource &source, Detector &controller);
+
+    /**
+     * @brief Detection stage: runs a detector over frames from the detection queue.
+     *
+     * @param detector The detector owned by this worker.
+     * @param controller The detector holding the current query.
+     */
+    void detectStage(Detector &detector, Detector &controller);
+
+    /**
+     * @brief Render stage: shows (or counts) the newest detected frames.
+     *
+     * @param controller The detector whose running state ends the stage; stopped on a key press.
+     */
+    void renderStage(Detector &controller);
+
+    /**
+     * @brief Hands a frame to the next stage, applying the drop policy if the queue is full.
+     *
+     * @param queue The queue of the next stage.
+     * @param frame The frame to hand over.
+     * @param controller The detector whose running state ends a blocking wait.
+     */
+    void forward(BoundedQueue<PipelineFrame> &queue, PipelineFrame &frame, Detector &controller);
+
+    /**
+     * @brief Returns a frame's buffer to the capture stage for reuse.
+     *
+     * @param frame The frame that left the pipeline.
+     */
+    void recycle(PipelineFrame &frame);
+
+    /** Sleeps briefly while a stage has nothing to do. */
+    static void idle();
+
+    /** The pipeline configuration. */
+    PipelineConfig config;
+
+    /** Frames waiting for detection. */
+    BoundedQueue<PipelineFrame> detectQueue;
+
+    /** Detected frames waiting to be rendered. */
+    BoundedQueue<PipelineFrame> renderQueue;
+
+    /** Frames whose buffers can be reused by the capture stage. */
+    BoundedQueue<PipelineFrame> recycleQueue;
+
+    /** Set once the capture stage has delivered its last frame. */
+    std::atomic<bool> captureDone{false};
+
+    /** Number of detection workers that have finished. */
+    std::atomic<unsigned> workersDone{0};
+
+    /** Frame counters of the current run. */
+    PipelineStats stats;
+};
+
+#endif
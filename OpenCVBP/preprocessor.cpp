@@ -0,0 +1,133 @@
+#include "preprocessor.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+#include "trace.hpp"
+
+namespace
+{
+// Fixed point BT.601 luma weights as used by cv::cvtColor(COLOR_BGR2GRAY).
+const unsigned grayShift = 14;
+const unsigned grayB = 1868;
+const unsigned grayG = 9617;
+const unsigned grayR = 4899;
+}
+
+Preprocessor::Preprocessor()
+{
+}
+
+Preprocessor::~Preprocessor()
+{
+}
+
+void Preprocessor::setColorTable(const ColorTable &table)
+{
+    colorTable = &table;
+}
+
+void Preprocessor::maskedGray(const cv::Mat &image, cv::Mat &gray) const
+{
+    CV_Assert(image.type() == CV_8UC3);
+    gray.create(image.size(), CV_8UC1);
+
+    int tiles = (image.rows + tileRows - 1) / tileRows;
+
+    cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range &range)
+                      {
+        thread_local std::vector<uchar> maskRow;
+        maskRow.resize(image.cols);
+
+        for (int tile = range.start; tile < range.end; tile++)
+        {
+            TRACE_SCOPE("preprocess.maskTile");
+            int rowBegin = tile * tileRows;
+            int rowEnd = std::min(rowBegin + tileRows, image.rows);
+
+            for (int y = rowBegin; y < rowEnd; y++)
+            {
+                maskedGrayRow(image.ptr<uchar>(y), maskRow.data(), gray.ptr<uchar>(y), image.cols);
+            }
+        } });
+}
+
+void Preprocessor::labelMap(const cv::Mat &image, cv::Mat &labels) const
+{
+    CV_Assert(image.type() == CV_8UC3);
+    labels.create(image.size(), CV_8UC1);
+
+    int tiles = (image.rows + tileRows - 1) / tileRows;
+    const uchar *table = colorTable->data();
+
+    cv::parallel_for_(cv::Range(0, tiles), [&](const cv::Range &range)
+                      {
+        for (int tile = range.start; tile < range.end; tile++)
+        {
+            TRACE_SCOPE("preprocess.labelTile");
+            int rowEnd = std::min((tile + 1) * tileRows, image.rows);
+
+            for (int y = tile * tileRows; y < rowEnd; y++)
+            {
+                const uchar *bgr = image.ptr<uchar>(y);
+                uchar *label = labels.ptr<uchar>(y);
+                for (int x = 0; x < image.cols; x++)
+                {
+                    label[x] = table[ColorTable::index(bgr[3 * x], bgr[3 * x + 1], bgr[3 * x + 2])];
+                }
+            }
+        } });
+}
+
+void Preprocessor::maskedGrayRow(const uchar *bgr, uchar *mask, uchar *gray, int width) const
+{
+    // The table lookup is a gather, so the mask is built in a scalar pass before the vector kernel.
+    const uchar *table = colorTable->data();
+    for (int x = 0; x < width; x++)
+    {
+        const uchar *color = bgr + 3 * x;
+        mask[x] = table[ColorTable::index(color[0], color[1], color[2])] != ColorTable::none ? 255 : 0;
+    }
+
+    int x = 0;
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    // VTraits and the named arithmetic work on both fixed width and scalable vectors; the
+    // operators and nlanes are gone from OpenCV builds with scalable vector support.
+    const int lanes = cv::VTraits<cv::v_uint8>::vlanes();
+    const cv::v_uint32 weightB = cv::vx_setall_u32(grayB), weightG = cv::vx_setall_u32(grayG), weightR = cv::vx_setall_u32(grayR);
+    auto weigh = [&](const cv::v_uint32 &b, const cv::v_uint32 &g, const cv::v_uint32 &r)
+    {
+        return cv::v_add(cv::v_add(cv::v_mul(b, weightB), cv::v_mul(g, weightG)), cv::v_mul(r, weightR));
+    };
+
+    for (; x <= width - lanes; x += lanes)
+    {
+        cv::v_uint8 b, g, r;
+        cv::v_load_deinterleave(bgr + 3 * x, b, g, r);
+
+        cv::v_uint16 b0, b1, g0, g1, r0, r1;
+        cv::v_expand(b, b0, b1);
+        cv::v_expand(g, g0, g1);
+        cv::v_expand(r, r0, r1);
+
+        cv::v_uint32 b00, b01, b10, b11, g00, g01, g10, g11, r00, r01, r10, r11;
+        cv::v_expand(b0, b00, b01);
+        cv::v_expand(b1, b10, b11);
+        cv::v_expand(g0, g00, g01);
+        cv::v_expand(g1, g10, g11);
+        cv::v_expand(r0, r00, r01);
+        cv::v_expand(r1, r10, r11);
+
+        cv::v_uint16 y0 = cv::v_rshr_pack<grayShift>(weigh(b00, g00, r00), weigh(b01, g01, r01));
+        cv::v_uint16 y1 = cv::v_rshr_pack<grayShift>(weigh(b10, g10, r10), weigh(b11, g11, r11));
+
+        cv::v_store(gray + x, cv::v_and(cv::v_pack(y0, y1), cv::vx_load(mask + x)));
+    }
+    cv::vx_cleanup();
+#endif
+
+    for (; x < width; x++)
+    {
+        const uchar *color = bgr + 3 * x;
+        gray[x] = mask[x] ? (uchar)((color[0] * grayB + color[1] * grayG + color[2] * grayR + (1u << (grayShift - 1))) >> grayShift) : 0;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include <opencv2/opencv.hpp>
+#include "colorTable.hpp"
+
+/**
+ * @class Preprocessor
+ * @brief Fused, row-tiled conversion of a BGR frame into the color-masked grayscale image.
+ *
+ * The classic preprocessing chain (BGR->HSV, inRange, bitwise_and, BGR->GRAY) streams the full
+ * frame through memory four times and allocates an intermediate image for every step. The
+ * Preprocessor produces the masked grayscale image in one pass: the frame is cut into tiles of
+ * a few rows that are processed in parallel. For every row, the mask is read from the color
+ * table (a pixel survives when it belongs to any color class, see ColorTable), and a vectorized
+ * kernel computes the gray value of every pixel and clears it where the mask is empty. No HSV
+ * conversion of the frame is needed.
+ */
+class Preprocessor
+{
+public:
+    Preprocessor();
+    virtual ~Preprocessor();
+
+    /**
+     * @brief Sets the color table whose classes define the mask.
+     *
+     * @param table The table; must outlive the preprocessor. Defaults to ColorTable::shared().
+     */
+    void setColorTable(const ColorTable &table);
+
+    /**
+     * @brief Computes the grayscale image of all pixels that belong to a color class, zero elsewhere.
+     *
+     * @param image The 8-bit BGR input image.
+     * @param gray Receives the 8-bit masked grayscale image; reused if it already has the right size.
+     */
+    void maskedGray(const cv::Mat &image, cv::Mat &gray) const;
+
+    /**
+     * @brief Labels every pixel with its color class in one pass.
+     *
+     * @param image The 8-bit BGR input image.
+     * @param labels Receives the 8-bit class ID of every pixel (ColorTable::none for no class);
+     *               reused if it already has the right size.
+     */
+    void labelMap(const cv::Mat &image, cv::Mat &labels) const;
+
+private:
+    /**
+     * @brief Processes one row of a tile.
+     *
+     * @param bgr The BGR pixels of the row.
+     * @param mask Scratch buffer of at least `width` bytes for the mask of the row.
+     * @param gray Receives the masked gray values of the row.
+     * @param width Number of pixels in the row.
+     */
+    void maskedGrayRow(const uchar *bgr, uchar *mask, uchar *gray, int width) const;
+
+    /** The color classes that define the mask. */
+    const ColorTable *colorTable = &ColorTable::shared();
+
+    /** Number of rows processed per parallel task. */
+    int tileRows = 8;
+};
+
+#endif
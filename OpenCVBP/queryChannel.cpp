@@ -0,0 +1,48 @@
+#include "queryChannel.hpp"
+
+QueryChannel::QueryChannel()
+    : current(std::make_shared<const QuerySnapshot>())
+{
+}
+
+QueryChannel::~QueryChannel()
+{
+}
+
+void QueryChannel::publish(const std::vector<Query> &queries)
+{
+    std::shared_ptr<QuerySnapshot> next = std::make_shared<QuerySnapshot>();
+    next->queries = queries;
+    next->active = true;
+    store(std::move(next));
+}
+
+void QueryChannel::deactivate()
+{
+    store(std::make_shared<QuerySnapshot>());
+}
+
+std::shared_ptr<const QuerySnapshot> QueryChannel::load() const
+{
+    return std::atomic_load(&current);
+}
+
+bool QueryChannel::refresh(std::shared_ptr<const QuerySnapshot> &snapshot) const
+{
+    if (snapshot && snapshot->version == version.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    snapshot = std::atomic_load(&current);
+    return true;
+}
+
+void QueryChannel::store(std::shared_ptr<QuerySnapshot> next)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    next->version = version.load(std::memory_order_relaxed) + 1;
+    unsigned long long published = next->version;
+    std::atomic_store(&current, std::shared_ptr<const QuerySnapshot>(std::move(next)));
+    version.store(published, std::memory_order_release);
+}
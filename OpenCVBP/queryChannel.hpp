@@ -0,0 +1,118 @@
+#ifndef QUERYCHANNEL_H
+#define QUERYCHANNEL_H
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <opencv2/opencv.hpp>
+#include "shapeClassifier.hpp"
+#include "colorTable.hpp"
+
+/**
+ * @struct Query
+ * @brief A shape and color combination to look for, e.g. {ShapeClass::Square, id of "geel"}.
+ *
+ * Names are resolved once, when the query is made (see ShapeClassifier::shapeClassFromName and
+ * ColorTable::find), so answering a query only compares IDs. By default every matching shape is
+ * reported; the options below narrow that down by confidence (see ContourFeatures::confidence).
+ */
+struct Query
+{
+    /** The shape to detect; a query for ShapeClass::None matches nothing. */
+    ShapeClass shape = ShapeClass::None;
+
+    /** Class ID (see ColorTable) of the color the shape must have. */
+    uchar color = ColorTable::none;
+
+    /** Report at most this many matches, the most confident first; 0 for all of them. */
+    size_t maxResults = 0;
+
+    /** Matches with a lower confidence are ignored. */
+    double minConfidence = 0.0;
+
+    /**
+     * Report only the first match, in contour order, that reaches `minConfidence`. When every
+     * query of a frame stops at its first match, classification itself stops once all are found.
+     */
+    bool stopAtFirst = false;
+};
+
+/**
+ * @struct QuerySnapshot
+ * @brief One published version of the queries; never modified once published.
+ */
+struct QuerySnapshot
+{
+    /** The shape and color combinations to look for. */
+    std::vector<Query> queries;
+
+    /** Whether detection is active; false after "stop" and before the first query. */
+    bool active = false;
+
+    /** Number of the publication, increasing by one with every publish() or deactivate(). */
+    unsigned long long version = 0;
+};
+
+/**
+ * @class QueryChannel
+ * @brief Hands the current queries from any number of writers to the detection threads.
+ *
+ * Writers never modify the queries in place: every update builds a new immutable snapshot and
+ * publishes it with a single atomic store, so a reader sees either the old or the new queries,
+ * never a mix. Readers keep their snapshot alive through a shared_ptr for as long as they use it
+ * (the old version is freed when its last reader lets go, as in RCU), and refresh() only touches
+ * the shared pointer when the version counter moved, so the per-frame cost of an unchanged query
+ * is one atomic load. Readers never take the writer lock.
+ */
+class QueryChannel
+{
+public:
+    QueryChannel();
+    virtual ~QueryChannel();
+
+    QueryChannel(const QueryChannel &) = delete;
+    QueryChannel &operator=(const QueryChannel &) = delete;
+
+    /**
+     * @brief Publishes new queries and activates detection; safe from any thread.
+     *
+     * @param queries The shape and color combinations to look for.
+     */
+    void publish(const std::vector<Query> &queries);
+
+    /**
+     * @brief Publishes a snapshot without queries that stops detection; safe from any thread.
+     */
+    void deactivate();
+
+    /** @return The latest snapshot. */
+    std::shared_ptr<const QuerySnapshot> load() const;
+
+    /**
+     * @brief Replaces a snapshot with the latest one if a newer version was published.
+     *
+     * Call at a frame boundary and use the snapshot for the whole frame.
+     *
+     * @param snapshot The snapshot of the caller, may be empty.
+     * @return True if the snapshot was replaced.
+     */
+    bool refresh(std::shared_ptr<const QuerySnapshot> &snapshot) const;
+
+private:
+    /** Publishes a snapshot as the next version. */
+    void store(std::shared_ptr<QuerySnapshot> next);
+
+    /** The latest snapshot, only accessed through std::atomic_load and std::atomic_store. */
+    std::shared_ptr<const QuerySnapshot> current;
+
+    /** Version of `current`, updated after it. */
+    std::atomic<unsigned long long> version{0};
+
+    /** Serializes writers so versions stay in publication order. */
+    std::mutex writeMutex;
+};
+
+#endif
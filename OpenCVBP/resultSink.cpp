@@ -0,0 +1,266 @@
+#include "resultSink.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+ResultSink::ResultSink(std::ostream &out)
+    : out(out)
+{
+    buffer.reserve(flushThreshold + 1024);
+}
+
+ResultSink::~ResultSink()
+{
+    flush();
+}
+
+std::unique_ptr<ResultSink> ResultSink::create(const std::string &format, const std::string &path)
+{
+    std::unique_ptr<std::ofstream> file;
+    if (!path.empty())
+    {
+        file = std::make_unique<std::ofstream>(path, std::ios::binary);
+        if (!*file)
+        {
+            std::cerr << "Error: Could not open output file " << path << std::endl;
+            return nullptr;
+        }
+    }
+    std::ostream &out = file ? *file : std::cout;
+
+    std::unique_ptr<ResultSink> sink;
+    if (format == "jsonl")
+        sink = std::make_unique<JsonLinesSink>(out);
+    else if (format == "csv")
+        sink = std::make_unique<CsvSink>(out);
+    else if (format == "binary")
+        sink = std::make_unique<BinarySink>(out);
+    else
+    {
+        std::cerr << "Invalid output format: " << format << std::endl;
+        return nullptr;
+    }
+
+    sink->file = std::move(file);
+    return sink;
+}
+
+void ResultSink::write(const DetectionRecord &record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    format(record);
+    if (buffer.size() >= flushThreshold)
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void ResultSink::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    out.flush();
+}
+
+void ResultSink::appendNumber(long long value)
+{
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+void ResultSink::appendNumber(double value)
+{
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+JsonLinesSink::JsonLinesSink(std::ostream &out)
+    : ResultSink(out)
+{
+}
+
+void JsonLinesSink::format(const DetectionRecord &record)
+{
+    buffer += "{\"source\":";
+    appendString(record.source);
+    buffer += ",\"frame\":";
+    appendNumber(record.frame);
+    buffer += record.found ? ",\"found\":true,\"shape\":" : ",\"found\":false,\"shape\":";
+    appendString(record.shape);
+    buffer += ",\"color\":";
+    appendString(record.color);
+
+    if (record.found)
+    {
+        buffer += ",\"track\":";
+        appendNumber(static_cast<long long>(record.trackId));
+        buffer += ",\"x\":";
+        appendNumber(static_cast<long long>(record.centroid.x));
+        buffer += ",\"y\":";
+        appendNumber(static_cast<long long>(record.centroid.y));
+        buffer += ",\"bbox\":[";
+        appendNumber(static_cast<long long>(record.boundingBox.x));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.y));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.width));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.height));
+        buffer += "],\"area\":";
+        appendNumber(record.area);
+        buffer += ",\"confidence\":";
+        appendNumber(record.confidence);
+        buffer += ",\"shape_time\":";
+        appendNumber(record.shapeTime);
+    }
+
+    buffer += ",\"frame_time\":";
+    appendNumber(record.frameTime);
+    buffer += "}\n";
+}
+
+void JsonLinesSink::appendString(std::string_view value)
+{
+    buffer += '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            buffer += '\\';
+            buffer += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            static const char hex[] = "0123456789abcdef";
+            buffer += "\\u00";
+            buffer += hex[(c >> 4) & 0xf];
+            buffer += hex[c & 0xf];
+        }
+        else
+        {
+            buffer += c;
+        }
+    }
+    buffer += '"';
+}
+
+CsvSink::CsvSink(std::ostream &out)
+    : ResultSink(out)
+{
+    buffer += "source,frame,found,shape,color,track,x,y,bbox_x,bbox_y,bbox_width,bbox_height,area,confidence,shape_time,frame_time\n";
+}
+
+void CsvSink::format(const DetectionRecord &record)
+{
+    appendField(record.source);
+    buffer += ',';
+    appendNumber(record.frame);
+    buffer += record.found ? ",1," : ",0,";
+    appendField(record.shape);
+    buffer += ',';
+    appendField(record.color);
+    buffer += ',';
+
+    if (record.found)
+    {
+        appendNumber(static_cast<long long>(record.trackId));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.centroid.x));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.centroid.y));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.x));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.y));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.width));
+        buffer += ',';
+        appendNumber(static_cast<long long>(record.boundingBox.height));
+        buffer += ',';
+        appendNumber(record.area);
+        buffer += ',';
+        appendNumber(record.confidence);
+        buffer += ',';
+        appendNumber(record.shapeTime);
+    }
+    else
+    {
+        buffer += ",,,,,,,,,";
+    }
+
+    buffer += ',';
+    appendNumber(record.frameTime);
+    buffer += '\n';
+}
+
+void CsvSink::appendField(std::string_view value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string_view::npos)
+    {
+        buffer += value;
+        return;
+    }
+
+    buffer += '"';
+    for (char c : value)
+    {
+        if (c == '"')
+        {
+            buffer += '"';
+        }
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+BinarySink::BinarySink(std::ostream &out)
+    : ResultSink(out)
+{
+    buffer += "SDR1";
+}
+
+void BinarySink::format(const DetectionRecord &record)
+{
+    size_t sourceLength = std::min<size_t>(record.source.size(), 0xffff);
+    size_t shapeLength = std::min<size_t>(record.shape.size(), 0xff);
+    size_t colorLength = std::min<size_t>(record.color.size(), 0xff);
+
+    appendRaw(static_cast<uint16_t>(sourceLength));
+    buffer.append(record.source, 0, sourceLength);
+    appendRaw(static_cast<int64_t>(record.frame));
+    appendRaw(static_cast<uint8_t>(record.found));
+    appendRaw(static_cast<uint8_t>(shapeLength));
+    buffer.append(record.shape, 0, shapeLength);
+    appendRaw(static_cast<uint8_t>(colorLength));
+    buffer.append(record.color, 0, colorLength);
+
+    appendRaw(static_cast<int32_t>(record.trackId));
+    appendRaw(static_cast<int32_t>(record.centroid.x));
+    appendRaw(static_cast<int32_t>(record.centroid.y));
+    appendRaw(static_cast<int32_t>(record.boundingBox.x));
+    appendRaw(static_cast<int32_t>(record.boundingBox.y));
+    appendRaw(static_cast<int32_t>(record.boundingBox.width));
+    appendRaw(static_cast<int32_t>(record.boundingBox.height));
+
+    appendRaw(static_cast<float>(record.area));
+    appendRaw(static_cast<float>(record.confidence));
+    appendRaw(static_cast<float>(record.shapeTime));
+    appendRaw(static_cast<float>(record.frameTime));
+}
+
+template <typename T>
+void BinarySink::appendRaw(T value)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::reverse(bytes, bytes + sizeof(T));
+#endif
+    buffer.append(bytes, sizeof(T));
+}
@@ -0,0 +1,196 @@
+#ifndef RESULTSINK_H
+#define RESULTSINK_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct DetectionRecord
+ * @brief One result of a query on one frame: a detected shape, or the absence of one.
+ */
+struct DetectionRecord
+{
+    /** Location of the source the frame was read from, "0" for the default camera. */
+    std::string source;
+
+    /** Index of the frame within its source. */
+    long long frame = 0;
+
+    /** True for a detection, false if the query matched nothing in the frame. */
+    bool found = false;
+
+    /** Lowercase shape name, the queried shape when nothing was found; must stay valid until written. */
+    std::string_view shape;
+
+    /** Lowercase color name, the queried color when nothing was found; must stay valid until written. */
+    std::string_view color;
+
+    /** Track ID of the shape, -1 when nothing was found. */
+    int trackId = -1;
+
+    /** Center of the shape in pixels. */
+    cv::Point centroid;
+
+    /** Bounding box of the contour in pixels. */
+    cv::Rect boundingBox;
+
+    /** Contour area in square pixels. */
+    double area = 0.0;
+
+    /** Confidence of the detection in [0, 1]. */
+    double confidence = 0.0;
+
+    /** Seconds spent classifying the geometry of this shape. */
+    double shapeTime = 0.0;
+
+    /** Seconds from the start of the frame until the record was written. */
+    double frameTime = 0.0;
+};
+
+/**
+ * @class ResultSink
+ * @brief Buffered writer of detection records in a machine-readable format.
+ *
+ * Records are formatted into an internal buffer that is written to the output stream in large
+ * blocks, never flushed per record, so high-rate batch runs are not bound by I/O. Call flush()
+ * (or destroy the sink) to push out the remaining records.
+ *
+ * write() and flush() may be called from several threads, e.g. by the detectors of all streams
+ * of a DetectorService; every record is appended as a whole.
+ */
+class ResultSink
+{
+public:
+    virtual ~ResultSink();
+
+    /**
+     * @brief Creates a sink by format name.
+     *
+     * @param format "jsonl", "csv" or "binary".
+     * @param path File to write to, empty for standard output.
+     * @return The sink, or nullptr if the format is unknown or the file cannot be opened.
+     */
+    static std::unique_ptr<ResultSink> create(const std::string &format, const std::string &path);
+
+    /**
+     * @brief Appends one record.
+     *
+     * @param record The record to write.
+     */
+    void write(const DetectionRecord &record);
+
+    /**
+     * @brief Writes all buffered records to the output stream and flushes it.
+     */
+    void flush();
+
+protected:
+    /**
+     * @param out The stream to write to.
+     */
+    explicit ResultSink(std::ostream &out);
+
+    /**
+     * @brief Appends the encoding of one record to the buffer.
+     *
+     * @param record The record to encode.
+     */
+    virtual void format(const DetectionRecord &record) = 0;
+
+    /** Appends an integer in decimal. */
+    void appendNumber(long long value);
+
+    /** Appends a floating point number in its shortest round-trip decimal form. */
+    void appendNumber(double value);
+
+    /** Records formatted but not yet written. */
+    std::string buffer;
+
+private:
+    /** Buffer size at which the buffer is written to the stream. */
+    static const size_t flushThreshold = 1 << 16;
+
+    /** The stream the records go to. */
+    std::ostream &out;
+
+    /** The file opened by create(), if any; `out` refers to it. */
+    std::unique_ptr<std::ofstream> file;
+
+    /** Serializes writers; uncontended, taking it costs about as much as formatting a number. */
+    std::mutex mutex;
+};
+
+/**
+ * @class JsonLinesSink
+ * @brief Writes one JSON object per line, e.g.
+ *
+ *     {"source":"img/","frame":3,"found":true,"shape":"vierkant","color":"geel","track":4,"x":120,"y":80,
+ *      "bbox":[100,60,40,40],"area":1600,"confidence":1,"shape_time":2.1e-05,"frame_time":0.0031}
+ */
+class JsonLinesSink : public ResultSink
+{
+public:
+    explicit JsonLinesSink(std::ostream &out);
+
+protected:
+    void format(const DetectionRecord &record) override;
+
+private:
+    /** Appends a JSON string literal. */
+    void appendString(std::string_view value);
+};
+
+/**
+ * @class CsvSink
+ * @brief Writes a header line followed by one comma separated line per record:
+ *
+ *     source,frame,found,shape,color,track,x,y,bbox_x,bbox_y,bbox_width,bbox_height,area,confidence,shape_time,frame_time
+ */
+class CsvSink : public ResultSink
+{
+public:
+    explicit CsvSink(std::ostream &out);
+
+protected:
+    void format(const DetectionRecord &record) override;
+
+private:
+    /** Appends a field, quoted if it contains a separator, quote or line break. */
+    void appendField(std::string_view value);
+};
+
+/**
+ * @class BinarySink
+ * @brief Writes compact little-endian records after the 4 byte magic "SDR1".
+ *
+ * Every record is laid out as:
+ *
+ *     u16 source length, source bytes
+ *     i64 frame
+ *     u8  found
+ *     u8  shape length, shape bytes
+ *     u8  color length, color bytes
+ *     i32 track, x, y, bbox x, bbox y, bbox width, bbox height
+ *     f32 area, confidence, shape time, frame time
+ */
+class BinarySink : public ResultSink
+{
+public:
+    explicit BinarySink(std::ostream &out);
+
+protected:
+    void format(const DetectionRecord &record) override;
+
+private:
+    /** Appends the little-endian bytes of an integer or float. */
+    template <typename T>
+    void appendRaw(T value);
+};
+
+#endif
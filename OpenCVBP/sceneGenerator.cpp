@@ -0,0 +1,151 @@
+#include "sceneGenerator.hpp"
+
+#include <sstream>
+
+std::vector<std::string> splitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+SceneGenerator::SceneGenerator(const SceneConfig &config)
+    : config(config),
+      rng(config.seed)
+{
+    calibrateColors();
+}
+
+SceneGenerator::~SceneGenerator()
+{
+}
+
+void SceneGenerator::generate(cv::Mat &image, std::vector<SceneShape> &truth)
+{
+    image.create(config.size, CV_8UC3);
+    image.setTo(cv::Scalar(20, 20, 20));
+    truth.clear();
+
+    int count = std::max(1, config.shapes);
+    int columns = std::max(1, (int)std::ceil(std::sqrt(count * (double)config.size.width / config.size.height)));
+    int rows = (count + columns - 1) / columns;
+    int cellWidth = config.size.width / columns;
+    int cellHeight = config.size.height / rows;
+    int maxRadius = std::min(cellWidth, cellHeight) * 2 / 5;
+
+    if (maxRadius < 12)
+    {
+        std::cerr << "Warning: " << count << " shapes do not fit a " << config.size.width << "x" << config.size.height
+                  << " scene; shapes will be too small to detect" << std::endl;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        SceneShape shape;
+        shape.shape = config.shapeNames[rng.uniform(0, (int)config.shapeNames.size())];
+        shape.color = config.colors[rng.uniform(0, (int)config.colors.size())];
+
+        int radius = std::max(4, rng.uniform(maxRadius * 3 / 4, maxRadius + 1));
+        int jitterX = std::max(1, cellWidth / 2 - radius);
+        int jitterY = std::max(1, cellHeight / 2 - radius);
+        shape.center = cv::Point((i % columns) * cellWidth + cellWidth / 2 + rng.uniform(-jitterX, jitterX),
+                                 (i / columns) * cellHeight + cellHeight / 2 + rng.uniform(-jitterY, jitterY));
+        shape.boundingRect = drawShape(image, shape.shape, shape.center, radius, getColorValue(shape.color));
+
+        truth.push_back(shape);
+    }
+
+    if (config.noise > 0)
+    {
+        cv::Mat noise(config.size, CV_16SC3);
+        cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(config.noise));
+        cv::add(image, noise, image, cv::noArray(), CV_8UC3);
+    }
+}
+
+cv::Scalar SceneGenerator::getColorValue(const std::string &color) const
+{
+    auto entry = palette.find(color);
+    return entry == palette.end() ? cv::Scalar(0, 0, 0) : entry->second;
+}
+
+void SceneGenerator::calibrateColors()
+{
+    Preprocessor preprocessor;
+    std::map<std::string, std::vector<cv::Scalar>> candidates;
+
+    for (int saturation = 20; saturation <= 250; saturation += 10)
+    {
+        for (int hue = 0; hue < 180; hue++)
+        {
+            cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(hue, saturation, 200));
+            cv::Mat bgr;
+            cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+
+            cv::Mat gray;
+            preprocessor.maskedGray(bgr, gray);
+            if (gray.at<uchar>(0, 0) == 0)
+            {
+                continue;
+            }
+
+            cv::Vec3b pixel = bgr.at<cv::Vec3b>(0, 0);
+            cv::Scalar value(pixel[0], pixel[1], pixel[2]);
+
+            const ColorTable &table = ColorTable::shared();
+            candidates[table.getName(table.classify(pixel[0], pixel[1], pixel[2]))].push_back(value);
+        }
+    }
+
+    for (const std::string &color : config.colors)
+    {
+        const std::vector<cv::Scalar> &values = candidates[color];
+        if (values.empty())
+        {
+            std::cerr << "Warning: no value found that the detector classifies as " << color << std::endl;
+            continue;
+        }
+        palette[color] = values[values.size() / 2];
+    }
+}
+
+cv::Rect SceneGenerator::drawShape(cv::Mat &image, const std::string &shape, cv::Point center, int radius, const cv::Scalar &color)
+{
+    if (shape == "driehoek")
+    {
+        std::vector<cv::Point> corners = {cv::Point(center.x, center.y - radius),
+                                          cv::Point(center.x - radius * 866 / 1000, center.y + radius / 2),
+                                          cv::Point(center.x + radius * 866 / 1000, center.y + radius / 2)};
+        cv::fillConvexPoly(image, corners, color);
+        return cv::boundingRect(corners);
+    }
+    if (shape == "vierkant")
+    {
+        int half = radius * 7 / 10;
+        cv::Rect square(center.x - half, center.y - half, 2 * half, 2 * half);
+        cv::rectangle(image, square, color, cv::FILLED);
+        return square;
+    }
+    if (shape == "rechthoek")
+    {
+        cv::Rect rectangle(center.x - radius, center.y - radius / 2, 2 * radius, radius);
+        cv::rectangle(image, rectangle, color, cv::FILLED);
+        return rectangle;
+    }
+    if (shape == "cirkel")
+    {
+        cv::circle(image, center, radius, color, cv::FILLED);
+        return cv::Rect(center.x - radius, center.y - radius, 2 * radius + 1, 2 * radius + 1);
+    }
+
+    cv::ellipse(image, center, cv::Size(radius, radius), 0, 180, 360, color, cv::FILLED);
+    return cv::Rect(center.x - radius, center.y - radius, 2 * radius + 1, radius + 1);
+}
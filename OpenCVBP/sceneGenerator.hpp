@@ -0,0 +1,125 @@
+#ifndef SCENEGENERATOR_H
+#define SCENEGENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+
+#include <opencv2/opencv.hpp>
+#include "colorTable.hpp"
+#include "preprocessor.hpp"
+
+/**
+ * @struct SceneShape
+ * @brief Ground truth of one shape drawn into a synthetic scene.
+ */
+struct SceneShape
+{
+    /** Lowercase shape name, e.g. "halve cirkel". */
+    std::string shape;
+
+    /** Lowercase color name, e.g. "geel". */
+    std::string color;
+
+    /** Center of the drawn shape. */
+    cv::Point center;
+
+    /** Bounding box of the drawn shape. */
+    cv::Rect boundingRect;
+};
+
+/**
+ * @struct SceneConfig
+ * @brief Parameters of the synthetic scenes.
+ */
+struct SceneConfig
+{
+    /** Resolution of the generated frames. */
+    cv::Size size = cv::Size(1280, 720);
+
+    /** Number of shapes per scene. */
+    int shapes = 20;
+
+    /** Shapes to draw, picked at random per shape. */
+    std::vector<std::string> shapeNames = {"driehoek", "vierkant", "rechthoek", "cirkel", "halve cirkel"};
+
+    /** Colors to draw, picked at random per shape. */
+    std::vector<std::string> colors = {"roze", "groen", "geel", "oranje"};
+
+    /** Standard deviation of the Gaussian noise added to every channel, 0 for none. */
+    double noise = 0.0;
+
+    /** Seed of the random generator, so scenes are reproducible. */
+    unsigned long long seed = 1;
+};
+
+/**
+ * @brief Splits a comma separated list, as given to --shape-types, --colors and the tuner's grids.
+ *
+ * @param list The list, e.g. "cirkel,halve cirkel".
+ * @return The non-empty items.
+ */
+std::vector<std::string> splitList(const std::string &list);
+
+/**
+ * @class SceneGenerator
+ * @brief Generates reproducible synthetic frames with known shapes and colors.
+ *
+ * Shapes are spread over a grid so they never overlap, with random size and jitter within their
+ * cell, on a dark background that the detector's color mask removes. The color of every named
+ * color is calibrated against the project's own preprocessing mask and color classifier, so a
+ * shape drawn as "geel" survives preprocessing and is classified as "geel".
+ */
+class SceneGenerator
+{
+public:
+    explicit SceneGenerator(const SceneConfig &config);
+    virtual ~SceneGenerator();
+
+    /**
+     * @brief Draws a new random scene.
+     *
+     * @param image Receives the 8-bit BGR scene.
+     * @param truth Receives the shapes that were drawn.
+     */
+    void generate(cv::Mat &image, std::vector<SceneShape> &truth);
+
+    /**
+     * @brief Returns the BGR value used to draw a color.
+     *
+     * @param color Lowercase color name.
+     * @return The calibrated BGR value, black if the color could not be calibrated.
+     */
+    cv::Scalar getColorValue(const std::string &color) const;
+
+private:
+    /**
+     * @brief Finds, for every configured color, a BGR value the detector masks in and classifies as that color.
+     */
+    void calibrateColors();
+
+    /**
+     * @brief Draws one filled shape.
+     *
+     * @param image The scene to draw on.
+     * @param shape Lowercase shape name.
+     * @param center Center of the shape.
+     * @param radius Half the extent of the shape.
+     * @param color BGR value to fill the shape with.
+     * @return The bounding box of the drawn shape.
+     */
+    cv::Rect drawShape(cv::Mat &image, const std::string &shape, cv::Point center, int radius, const cv::Scalar &color);
+
+    /** The scene parameters. */
+    SceneConfig config;
+
+    /** Random generator for placement, size, shape and color. */
+    cv::RNG rng;
+
+    /** Calibrated BGR value per color name. */
+    std::map<std::string, cv::Scalar> palette;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "shapeClassifier.hpp"
+
+ShapeClassifier::ShapeClassifier()
+{
+}
+
+ShapeClassifier::~ShapeClassifier()
+{
+}
+
+ContourFeatures ShapeClassifier::analyze(cv::InputArray contour) const
+{
+    cv::Mat points = contour.getMat();
+    int count = points.checkVector(2, CV_32S);
+    if (count < 0 || !points.isContinuous())
+    {
+        ContourFeatures features;
+        features.rejectedBy = RejectStage::Points;
+        return features;
+    }
+    return analyze(points.ptr<cv::Point>(), count);
+}
+
+namespace
+{
+// How far a feature lies inside its accepted range, in units of the margin, clamped to [0, 1].
+double insideBy(double distance, double margin)
+{
+    return std::clamp(distance / margin, 0.0, 1.0);
+}
+}
+
+ContourFeatures ShapeClassifier::analyze(const cv::Point *points, int count) const
+{
+    ContourFeatures features;
+
+    // A closed contour needs three points to enclose any area.
+    if (count < 3)
+    {
+        features.rejectedBy = RejectStage::Points;
+        return features;
+    }
+
+    // The enclosed area never exceeds the bounding box, and the box takes one pass of comparisons.
+    int minX = points[0].x;
+    int maxX = points[0].x;
+    int minY = points[0].y;
+    int maxY = points[0].y;
+    for (int i = 1; i < count; i++)
+    {
+        minX = std::min(minX, points[i].x);
+        maxX = std::max(maxX, points[i].x);
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+    }
+    if (static_cast<double>(maxX - minX) * (maxY - minY) < minArea)
+    {
+        features.rejectedBy = RejectStage::BoundingBox;
+        return features;
+    }
+
+    cv::Mat contour(count, 1, CV_32SC2, const_cast<cv::Point *>(points));
+    features.area = fabs(cv::contourArea(contour));
+    if (features.area < minArea)
+    {
+        features.rejectedBy = RejectStage::Area;
+        return features;
+    }
+
+    features.perimeter = cv::arcLength(contour, true);
+
+    thread_local std::vector<cv::Point> approx;
+    cv::approxPolyDP(contour, approx, features.perimeter * approxEpsilon, true);
+    if (!cv::isContourConvex(approx))
+    {
+        features.rejectedBy = RejectStage::Convexity;
+        return features;
+    }
+
+    features.vertices = approx.size();
+    features.boundingRect = cv::boundingRect(approx);
+    features.aspectRatio = (double)features.boundingRect.width / features.boundingRect.height;
+    features.circularity = 4 * M_PI * features.area / (features.perimeter * features.perimeter);
+    features.center = cv::Point(features.boundingRect.x + features.boundingRect.width / 2, features.boundingRect.y + features.boundingRect.height / 2);
+
+    // Score of the weakest criterion of the class the contour is labelled with.
+    double inside = 0.0;
+    double aspectDeviation = std::abs(features.aspectRatio - 1);
+
+    if (features.vertices == 3)
+    {
+        features.shapeClass = ShapeClass::Triangle;
+        inside = insideBy(minCircularity - features.circularity, minCircularity - triangleCircularity);
+    }
+    else if (features.vertices == 4)
+    {
+        double min_distance = std::numeric_limits<double>::max();
+        double max_distance = 0.0;
+
+        for (size_t j = 0; j < approx.size(); j++)
+        {
+            double distance = cv::norm(approx[j] - approx[(j + 1) % approx.size()]);
+            min_distance = std::min(min_distance, distance);
+            max_distance = std::max(max_distance, distance);
+        }
+
+        double ratio = max_distance / min_distance;
+        double adjustedAspectRatio = features.aspectRatio > 1 ? features.aspectRatio : 1 / features.aspectRatio;
+
+        if (ratio <= maxSquareRatio && ratio >= minSquareRatio)
+        {
+            features.shapeClass = ShapeClass::Square;
+            inside = insideBy(std::min(ratio - minSquareRatio, maxSquareRatio - ratio), maxSquareRatio - 1);
+        }
+        else if (adjustedAspectRatio > minRectangleAspect)
+        {
+            features.shapeClass = ShapeClass::Rectangle;
+            inside = std::min(insideBy(ratio - maxSquareRatio, maxSquareRatio - 1),
+                              insideBy(adjustedAspectRatio - minRectangleAspect, minRectangleAspect - 1));
+        }
+    }
+    else if (features.vertices > 4)
+    {
+        if (features.circularity > minCircularity && aspectDeviation < maxCircleAspectDeviation)
+        {
+            cv::Point2f center;
+            cv::minEnclosingCircle(contour, center, features.radius);
+            features.center = cv::Point(center.x, center.y);
+            features.shapeClass = ShapeClass::Circle;
+            inside = std::min(insideBy(features.circularity - minCircularity, 1 - minCircularity),
+                              insideBy(maxCircleAspectDeviation - aspectDeviation, maxCircleAspectDeviation));
+        }
+        else
+        {
+            features.shapeClass = ShapeClass::HalfCircle;
+            inside = std::min(insideBy(static_cast<double>(features.vertices) - 4, halfCircleVertexMargin),
+                              std::max(insideBy(minCircularity - features.circularity, 1 - minCircularity),
+                                       insideBy(aspectDeviation - maxCircleAspectDeviation, maxCircleAspectDeviation)));
+        }
+    }
+
+    if (features.shapeClass != ShapeClass::None)
+    {
+        features.confidence = 0.5 + 0.5 * inside;
+    }
+    return features;
+}
+
+double ShapeClassifier::getMinArea() const
+{
+    return minArea;
+}
+
+void ShapeClassifier::setMinArea(double minArea)
+{
+    this->minArea = minArea;
+}
+
+namespace
+{
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Compares case-insensitively against a lowercase alias, a whitespace run matching one space.
+bool matchesAlias(std::string_view name, const char *alias)
+{
+    size_t position = 0;
+    while (position < name.size())
+    {
+        if (isSpace(name[position]))
+        {
+            if (*alias++ != ' ')
+                return false;
+            while (position < name.size() && isSpace(name[position]))
+                position++;
+        }
+        else if (std::tolower(static_cast<unsigned char>(name[position++])) != *alias++)
+        {
+            return false;
+        }
+    }
+    return *alias == '\0';
+}
+}
+
+ShapeClass ShapeClassifier::shapeClassFromName(std::string_view name)
+{
+    for (const ShapeAlias &alias : shapeAliases)
+    {
+        if (matchesAlias(name, alias.name))
+        {
+            return alias.shapeClass;
+        }
+    }
+    return ShapeClass::None;
+}
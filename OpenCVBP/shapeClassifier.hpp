@@ -0,0 +1,303 @@
+#ifndef SHAPECLASSIFIER_H
+#define SHAPECLASSIFIER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The shape classes a contour can be labelled with.
+ */
+enum class ShapeClass
+{
+    None,
+    Triangle,
+    Square,
+    Rectangle,
+    Circle,
+    HalfCircle
+};
+
+/**
+ * @struct ShapeAlias
+ * @brief A name under which a shape class can be asked for.
+ */
+struct ShapeAlias
+{
+    /** Lowercase name, words separated by single spaces. */
+    const char *name;
+
+    /** The shape class the name denotes. */
+    ShapeClass shapeClass;
+};
+
+/** Dutch and English names of the shape classes, accepted wherever a shape is named. */
+inline constexpr ShapeAlias shapeAliases[] = {{"driehoek", ShapeClass::Triangle},
+                                              {"triangle", ShapeClass::Triangle},
+                                              {"vierkant", ShapeClass::Square},
+                                              {"square", ShapeClass::Square},
+                                              {"rechthoek", ShapeClass::Rectangle},
+                                              {"rectangle", ShapeClass::Rectangle},
+                                              {"cirkel", ShapeClass::Circle},
+                                              {"circle", ShapeClass::Circle},
+                                              {"halve cirkel", ShapeClass::HalfCircle},
+                                              {"half circle", ShapeClass::HalfCircle},
+                                              {"semicircle", ShapeClass::HalfCircle}};
+
+/** Lowercase name of every shape class, indexed by the class, as written to results. */
+inline constexpr const char *shapeClassKeys[] = {"", "driehoek", "vierkant", "rechthoek", "cirkel", "halve cirkel"};
+
+/** Display name of every shape class, indexed by the class. */
+inline constexpr const char *shapeClassNames[] = {"Unknown", "Driehoek", "Vierkant", "Rechthoek", "Cirkel", "Halve Cirkel"};
+
+/**
+ * @enum RejectStage
+ * @brief The stage of the rejection cascade of ShapeClassifier::analyze() that discarded a contour.
+ */
+enum class RejectStage
+{
+    /** The contour passed every stage. */
+    None,
+
+    /** Too few points to enclose an area. */
+    Points,
+
+    /** Bounding box smaller than the minimum area. */
+    BoundingBox,
+
+    /** Enclosed area smaller than the minimum area. */
+    Area,
+
+    /** Approximated polygon not convex. */
+    Convexity
+};
+
+/**
+ * @struct RejectStats
+ * @brief Number of contours of one frame discarded by each stage of the rejection cascade.
+ */
+struct RejectStats
+{
+    /** All contours. */
+    unsigned long long contours = 0;
+
+    /** Contours discarded for having fewer than three points. */
+    unsigned long long points = 0;
+
+    /** Contours discarded by their bounding box. */
+    unsigned long long boundingBox = 0;
+
+    /** Contours discarded by their area. */
+    unsigned long long area = 0;
+
+    /** Contours discarded because their approximation is not convex. */
+    unsigned long long convexity = 0;
+
+    /** Contours that passed the cascade but matched no shape class. */
+    unsigned long long unclassified = 0;
+
+    /**
+     * @brief Counts one contour.
+     *
+     * @param stage The stage that discarded it, None if it passed.
+     * @param shapeClass Its shape class.
+     */
+    void add(RejectStage stage, ShapeClass shapeClass)
+    {
+        contours++;
+        switch (stage)
+        {
+        case RejectStage::Points:
+            points++;
+            break;
+        case RejectStage::BoundingBox:
+            boundingBox++;
+            break;
+        case RejectStage::Area:
+            area++;
+            break;
+        case RejectStage::Convexity:
+            convexity++;
+            break;
+        case RejectStage::None:
+            unclassified += shapeClass == ShapeClass::None;
+            break;
+        }
+    }
+
+    /** @return The number of contours discarded by the cascade. */
+    unsigned long long rejected() const
+    {
+        return points + boundingBox + area + convexity;
+    }
+};
+
+/**
+ * @struct ContourFeatures
+ * @brief Geometric features of one contour, computed once per frame and shared by all queries.
+ */
+struct ContourFeatures
+{
+    /** The shape class the contour was labelled with, None if it matched no shape. */
+    ShapeClass shapeClass = ShapeClass::None;
+
+    /** The stage of the rejection cascade that discarded the contour, None if it passed. */
+    RejectStage rejectedBy = RejectStage::None;
+
+    /**
+     * How clearly the contour meets the criteria of its shape class: 0.5 right at a threshold,
+     * 1 when every feature lies at least a threshold's width inside its range; 0 for None.
+     */
+    double confidence = 0.0;
+
+    /** Absolute area enclosed by the contour. */
+    double area = 0.0;
+
+    /** Length of the closed contour. */
+    double perimeter = 0.0;
+
+    /** 4 * pi * area / perimeter^2, 1 for a perfect circle. */
+    double circularity = 0.0;
+
+    /** Width / height of the bounding box of the approximated polygon. */
+    double aspectRatio = 0.0;
+
+    /** Number of vertices of the approximated polygon. */
+    size_t vertices = 0;
+
+    /** Bounding box of the approximated polygon. */
+    cv::Rect boundingRect;
+
+    /** Center of the shape: the enclosing circle center for circles, the bounding box center otherwise. */
+    cv::Point center;
+
+    /** Radius of the minimum enclosing circle, only set for circles. */
+    float radius = 0.0f;
+};
+
+/**
+ * @class ShapeClassifier
+ * @brief Labels contours with their shape class in a single pass.
+ *
+ * Every contour is approximated and measured exactly once: the polygon approximation,
+ * perimeter, area, convexity, bounding box and circularity are computed up front and the
+ * contour is then assigned the first shape class whose criteria it meets. The resulting
+ * features can answer any number of shape queries without touching the contours again.
+ *
+ * Most contours in a noisy frame are small Canny fragments, so before any of that a contour
+ * passes a cascade of ever more expensive checks and is dropped at the first it fails: its
+ * point count, the size of its bounding box, its area and the convexity of its approximation.
+ * Each check reuses what the earlier ones computed, and a fragment rejected by the first two
+ * costs a single pass over its points.
+ */
+class ShapeClassifier
+{
+public:
+    ShapeClassifier();
+    virtual ~ShapeClassifier();
+
+    /**
+     * @brief Computes the features of a single contour and labels it with its shape class.
+     *
+     * Contours rejected by the cascade (fewer than three points, a bounding box or area below the
+     * minimum area, or a non-convex approximation) are labelled None, with the rejecting stage in
+     * `rejectedBy`. Polygons with three vertices are triangles; four vertices make a square when the
+     * side lengths are within the square ratio, otherwise a rectangle when the bounding box is clearly
+     * elongated. Polygons with more vertices are circles when circularity and aspect ratio are close
+     * to those of a circle, and half circles otherwise.
+     *
+     * The same features then give the confidence of the label: every criterion of the class scores
+     * how far the feature lies inside its accepted range, scaled by the width of the threshold's
+     * margin (e.g. a side ratio of 1.15 is halfway inside the square ratio 1.3), and the weakest
+     * criterion decides. Criteria that are only implied by the branch taken are scored too: a
+     * triangle should not be round, and a half circle should have clearly failed the circle test
+     * and have more than just five vertices.
+     *
+     * @param points The points of the closed contour.
+     * @param count Number of points.
+     * @return The features of the contour.
+     */
+    ContourFeatures analyze(const cv::Point *points, int count) const;
+
+    /**
+     * @brief Computes the features of a single contour and labels it with its shape class.
+     *
+     * @param contour The contour to analyse: a std::vector<cv::Point> or a CV_32SC2 matrix.
+     * @return The features of the contour.
+     */
+    ContourFeatures analyze(cv::InputArray contour) const;
+
+    /** @return The minimum contour area, in square pixels, below which contours are ignored. */
+    double getMinArea() const;
+
+    /**
+     * @brief Sets the minimum contour area below which contours are ignored.
+     *
+     * @param minArea The minimum area in square pixels.
+     */
+    void setMinArea(double minArea);
+
+    /**
+     * @brief Maps a shape name (e.g. "Halve cirkel" or "half circle") to its shape class.
+     *
+     * Any of the shapeAliases matches, case-insensitively; runs of whitespace between words
+     * count as a single space.
+     *
+     * @param name The shape name as used in commands.
+     * @return The shape class, None if the name is unknown.
+     */
+    static ShapeClass shapeClassFromName(std::string_view name);
+
+    /**
+     * @brief Returns the display name of a shape class (e.g. "Halve Cirkel").
+     *
+     * @param shapeClass The shape class.
+     * @return The display name.
+     */
+    static constexpr const char *getShapeClassName(ShapeClass shapeClass)
+    {
+        return shapeClassNames[static_cast<int>(shapeClass)];
+    }
+
+    /**
+     * @brief Returns the lowercase command name of a shape class (e.g. "halve cirkel").
+     *
+     * @param shapeClass The shape class.
+     * @return The name accepted by shapeClassFromName(), "" for None.
+     */
+    static constexpr const char *getShapeClassKey(ShapeClass shapeClass)
+    {
+        return shapeClassKeys[static_cast<int>(shapeClass)];
+    }
+
+private:
+    /** Contours enclosing less than this area are ignored. */
+    double minArea = 100.0;
+
+    /** Approximation accuracy as a fraction of the contour perimeter. */
+    double approxEpsilon = 0.02;
+
+    /** Accepted range of the longest / shortest side ratio of a square. */
+    double minSquareRatio = 0.7;
+    double maxSquareRatio = 1.3;
+
+    /** Minimum (adjusted) bounding box aspect ratio of a rectangle. */
+    double minRectangleAspect = 1.1;
+
+    /** Minimum circularity and maximum aspect ratio deviation of a circle. */
+    double minCircularity = 0.8;
+    double maxCircleAspectDeviation = 0.2;
+
+    /** Circularity of an equilateral triangle, the roundest a triangle gets. */
+    double triangleCircularity = M_PI * std::sqrt(3.0) / 9;
+
+    /** Vertices beyond four at which a half circle is fully confident. */
+    double halfCircleVertexMargin = 2.0;
+};
+
+#endif
@@ -0,0 +1,188 @@
+#include "trace.hpp"
+
+#ifdef SHAPEDETECTOR_TRACE
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+struct TraceEvent
+{
+    const char *name;
+    long long begin;
+    long long duration;
+};
+
+/**
+ * Ring buffer of the events of one thread. Only the owning thread writes; readers use the
+ * published head and skip the slots the writer may be overwriting.
+ */
+class TraceBuffer
+{
+public:
+    static const size_t capacity = 1 << 14;
+
+    explicit TraceBuffer(int threadId)
+        : events(new TraceEvent[capacity]),
+          threadId(threadId)
+    {
+    }
+
+    void push(const char *name, long long begin, long long end)
+    {
+        unsigned long long position = head.load(std::memory_order_relaxed);
+        TraceEvent &event = events[position & (capacity - 1)];
+        event.name = name;
+        event.begin = begin;
+        event.duration = end - begin;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    /** Copies the events from position `from` on that are still buffered; returns the new head. */
+    unsigned long long read(unsigned long long from, std::vector<TraceEvent> &out) const
+    {
+        unsigned long long end = head.load(std::memory_order_acquire);
+        unsigned long long oldest = end > capacity / 2 ? end - capacity / 2 : 0;
+        for (unsigned long long position = std::max(from, oldest); position < end; position++)
+        {
+            out.push_back(events[position & (capacity - 1)]);
+        }
+        return end;
+    }
+
+    int getThreadId() const
+    {
+        return threadId;
+    }
+
+private:
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<unsigned long long> head{0};
+    int threadId;
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<TraceBuffer>> registry;
+std::vector<unsigned long long> summarized;
+
+std::atomic<long long> summaryInterval{0};
+std::atomic<long long> nextSummary{0};
+
+TraceBuffer &threadBuffer()
+{
+    thread_local TraceBuffer *buffer = nullptr;
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<TraceBuffer>(static_cast<int>(registry.size())));
+        summarized.push_back(0);
+        buffer = registry.back().get();
+    }
+    return *buffer;
+}
+}
+
+bool Trace::isEnabled()
+{
+    return true;
+}
+
+void Trace::record(const char *name, long long begin, long long end)
+{
+    threadBuffer().push(name, begin, end);
+}
+
+bool Trace::exportChromeTrace(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Error: Could not write trace " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<TraceEvent> events;
+    bool first = true;
+
+    file << "{\"traceEvents\":[\n";
+    for (const std::unique_ptr<TraceBuffer> &buffer : registry)
+    {
+        events.clear();
+        buffer->read(0, events);
+        for (const TraceEvent &event : events)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->getThreadId()
+                 << std::fixed << std::setprecision(3) << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << event.duration / 1000.0 << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+    return true;
+}
+
+void Trace::printSummary(std::ostream &out)
+{
+    struct Totals
+    {
+        unsigned long long count = 0;
+        long long sum = 0;
+        long long max = 0;
+    };
+
+    std::map<std::string, Totals> totals;
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (size_t i = 0; i < registry.size(); i++)
+        {
+            summarized[i] = registry[i]->read(summarized[i], events);
+        }
+    }
+
+    for (const TraceEvent &event : events)
+    {
+        Totals &entry = totals[event.name];
+        entry.count++;
+        entry.sum += event.duration;
+        entry.max = std::max(entry.max, event.duration);
+    }
+
+    out << std::left << std::setw(24) << "scope" << std::right << std::setw(10) << "count" << std::setw(12) << "mean us" << std::setw(12) << "max us" << '\n';
+    for (const auto &entry : totals)
+    {
+        out << std::left << std::setw(24) << entry.first << std::right << std::setw(10) << entry.second.count << std::fixed << std::setprecision(1)
+            << std::setw(12) << entry.second.sum / 1000.0 / entry.second.count << std::setw(12) << entry.second.max / 1000.0 << '\n';
+    }
+    out.flush();
+}
+
+void Trace::setSummaryInterval(double seconds)
+{
+    summaryInterval = static_cast<long long>(seconds * 1e9);
+    nextSummary = now() + summaryInterval;
+}
+
+void Trace::tick()
+{
+    long long interval = summaryInterval.load(std::memory_order_relaxed);
+    if (interval <= 0)
+    {
+        return;
+    }
+
+    long long due = nextSummary.load(std::memory_order_relaxed);
+    long long current = now();
+    if (current >= due && nextSummary.compare_exchange_strong(due, current + interval))
+    {
+        printSummary(std::cerr);
+    }
+}
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <iostream>
+#include <string>
+#include <chrono>
+
+/**
+ * @file trace.hpp
+ * @brief Low-overhead scoped timers for the detection hot path.
+ *
+ * Tracing is compiled in only when SHAPEDETECTOR_TRACE is defined ("make TRACE=1"). Without it,
+ * TRACE_SCOPE expands to an empty statement, the Trace functions are inline no-ops and trace.cpp
+ * compiles to nothing, so no timer, registry or per-frame check is left at all.
+ *
+ * When enabled, every TRACE_SCOPE records a (name, begin, duration) event into a fixed-size
+ * ring buffer owned by the calling thread, so recording never takes a lock or allocates after
+ * the thread's first event. The name must be a string literal. Events can be exported in the
+ * Chrome trace format (chrome://tracing, Perfetto) and summarised periodically per name.
+ */
+
+#ifdef SHAPEDETECTOR_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ScopedTrace TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) \
+    do                    \
+    {                     \
+    } while (0)
+#endif
+
+#ifdef SHAPEDETECTOR_TRACE
+
+/**
+ * @class Trace
+ * @brief Records, exports and summarises trace events.
+ */
+class Trace
+{
+public:
+    /** @return True if tracing was compiled in. */
+    static bool isEnabled();
+
+    /** @return The current time in nanoseconds on the trace clock. */
+    static long long now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Records one event into the calling thread's ring buffer.
+     *
+     * @param name Name of the traced scope; must outlive the trace (a string literal).
+     * @param begin Start time in nanoseconds.
+     * @param end End time in nanoseconds.
+     */
+    static void record(const char *name, long long begin, long long end);
+
+    /**
+     * @brief Writes the buffered events of all threads as a Chrome trace JSON file.
+     *
+     * Best called when the traced threads are idle; events being overwritten while the export
+     * runs may be skipped.
+     *
+     * @param path The file to write.
+     * @return True if the file was written.
+     */
+    static bool exportChromeTrace(const std::string &path);
+
+    /**
+     * @brief Prints count, mean and max duration per scope for the events since the last summary.
+     *
+     * @param out The stream to print to.
+     */
+    static void printSummary(std::ostream &out);
+
+    /**
+     * @brief Sets how often tick() prints a summary.
+     *
+     * @param seconds Interval between summaries; 0 disables periodic summaries.
+     */
+    static void setSummaryInterval(double seconds);
+
+    /**
+     * @brief Prints a summary to standard error when the summary interval has elapsed.
+     *
+     * Called once per frame by the detector; cheap when no summary is due.
+     */
+    static void tick();
+};
+
+/**
+ * @class ScopedTrace
+ * @brief Records the lifetime of a scope as a trace event; use through TRACE_SCOPE.
+ */
+class ScopedTrace
+{
+public:
+    explicit ScopedTrace(const char *name)
+        : name(name),
+          begin(Trace::now())
+    {
+    }
+
+    ~ScopedTrace()
+    {
+        Trace::record(name, begin, Trace::now());
+    }
+
+    ScopedTrace(const ScopedTrace &) = delete;
+    ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+private:
+    /** Name of the traced scope. */
+    const char *name;
+
+    /** Time the scope was entered. */
+    long long begin;
+};
+
+#else
+
+/**
+ * @class Trace
+ * @brief Stands in for the trace functions when tracing is not compiled in; every call is a no-op.
+ */
+class Trace
+{
+public:
+    static constexpr bool isEnabled()
+    {
+        return false;
+    }
+
+    static void record(const char *, long long, long long)
+    {
+    }
+
+    static bool exportChromeTrace(const std::string &)
+    {
+        return false;
+    }
+
+    static void printSummary(std::ostream &)
+    {
+    }
+
+    static void setSummaryInterval(double)
+    {
+    }
+
+    static void tick()
+    {
+    }
+};
+
+#endif
+
+#endif
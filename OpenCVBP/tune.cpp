@@ -0,0 +1,443 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include "detector.hpp"
+#include "sceneGenerator.hpp"
+
+namespace
+{
+/**
+ * @struct LabelledImage
+ * @brief An image with the shapes it is known to contain.
+ */
+struct LabelledImage
+{
+    cv::Mat image;
+    std::vector<SceneShape> truth;
+};
+
+/**
+ * @struct Candidate
+ * @brief One point of the parameter grid and its score.
+ */
+struct Candidate
+{
+    CannyThresholds canny;
+    int saturationShift = 0;
+    int minValue = 0;
+
+    /** The configured color classes with the candidate's saturation and value bounds. */
+    ColorTable table;
+
+    double precision = 0.0;
+    double recall = 0.0;
+    double f1 = 0.0;
+    double contours = 0.0;
+    double milliseconds = 0.0;
+
+    /** Whether the F1 score is within the tolerance of the best, so its latency was measured serially. */
+    bool shortlisted = false;
+};
+
+std::vector<int> parseList(const std::string &list)
+{
+    std::vector<int> values;
+    for (const std::string &item : splitList(list))
+    {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+/**
+ * @brief Reads a labels file with lines "image,shape,color,x,y,width,height".
+ *
+ * A line with only an image adds an image without shapes. Image paths are relative to the file.
+ */
+bool loadLabels(const std::string &path, std::vector<LabelledImage> &images)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Error: Could not open labels file " << path << std::endl;
+        return false;
+    }
+
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::map<std::string, size_t> imageIndex;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        std::vector<std::string> fields = splitList(line);
+        if (fields.empty() || fields[0][0] == '#')
+        {
+            continue;
+        }
+        if (fields.size() != 1 && fields.size() != 7)
+        {
+            std::cerr << path << ":" << lineNumber << ": expected image,shape,color,x,y,width,height" << std::endl;
+            return false;
+        }
+
+        auto found = imageIndex.find(fields[0]);
+        if (found == imageIndex.end())
+        {
+            LabelledImage labelled;
+            labelled.image = cv::imread((directory / fields[0]).string(), cv::IMREAD_COLOR);
+            if (labelled.image.empty())
+            {
+                std::cerr << path << ":" << lineNumber << ": could not read image " << fields[0] << std::endl;
+                return false;
+            }
+            found = imageIndex.emplace(fields[0], images.size()).first;
+            images.push_back(labelled);
+        }
+        if (fields.size() == 1)
+        {
+            continue;
+        }
+
+        if (!Detector::isKnownShape(fields[1]) || !Detector::isKnownColor(fields[2]))
+        {
+            std::cerr << path << ":" << lineNumber << ": unknown shape or color " << fields[1] << " " << fields[2] << std::endl;
+            return false;
+        }
+        SceneShape shape;
+        shape.shape = ShapeClassifier::getShapeClassKey(ShapeClassifier::shapeClassFromName(fields[1]));
+        shape.color = ColorTable::shared().getName(ColorTable::shared().find(fields[2]));
+        try
+        {
+            shape.boundingRect = cv::Rect(std::stoi(fields[3]), std::stoi(fields[4]), std::stoi(fields[5]), std::stoi(fields[6]));
+        }
+        catch (const std::logic_error &)
+        {
+            std::cerr << path << ":" << lineNumber << ": invalid bounding box" << std::endl;
+            return false;
+        }
+        shape.center = cv::Point(shape.boundingRect.x + shape.boundingRect.width / 2, shape.boundingRect.y + shape.boundingRect.height / 2);
+        images[found->second].truth.push_back(shape);
+    }
+    return true;
+}
+
+/**
+ * @brief Detects every shape and color in every image with the candidate's parameters and scores the result.
+ *
+ * A matched shape is correct when its centroid lies in the box of a labelled shape of the same
+ * shape and color; a labelled shape is found when at least one correct shape lies in its box.
+ */
+void evaluate(Candidate &candidate, const std::vector<LabelledImage> &images, int repeats)
+{
+    Detector detector;
+    detector.setAnnotate(false);
+    detector.setCannyThresholds(candidate.canny);
+    detector.setColorTable(candidate.table);
+
+    std::vector<Query> queries;
+    for (int shape = static_cast<int>(ShapeClass::Triangle); shape <= static_cast<int>(ShapeClass::HalfCircle); shape++)
+    {
+        for (size_t color = 1; color <= candidate.table.getClasses().size(); color++)
+        {
+            queries.push_back(Query{static_cast<ShapeClass>(shape), static_cast<uchar>(color)});
+        }
+    }
+
+    size_t matched = 0;
+    size_t correct = 0;
+    size_t expected = 0;
+    size_t found = 0;
+    double contours = 0.0;
+    double seconds = 0.0;
+    std::vector<bool> hit;
+
+    cv::Mat warmup = images[0].image;
+    detector.detectShapes(warmup, queries);
+
+    for (int repeat = 0; repeat < repeats; repeat++)
+    {
+        for (const LabelledImage &labelled : images)
+        {
+            cv::Mat image = labelled.image;
+            detector.detectShapes(image, queries);
+            seconds += detector.getFrameTimings().total;
+            contours += detector.getArenaStats().allocations;
+            if (repeat > 0)
+            {
+                continue;
+            }
+
+            const DetectionStore &detections = detector.getDetections();
+            hit.assign(labelled.truth.size(), false);
+            for (size_t d : detections.matched())
+            {
+                matched++;
+                bool isCorrect = false;
+                for (size_t t = 0; t < labelled.truth.size(); t++)
+                {
+                    const SceneShape &truth = labelled.truth[t];
+                    if (truth.boundingRect.contains(detections.getCentroid(d)) &&
+                        ShapeClassifier::shapeClassFromName(truth.shape) == detections.getShapeClass(d) &&
+                        candidate.table.find(truth.color) == detections.getColor(d))
+                    {
+                        hit[t] = true;
+                        isCorrect = true;
+                    }
+                }
+                correct += isCorrect;
+            }
+            expected += labelled.truth.size();
+            found += std::count(hit.begin(), hit.end(), true);
+        }
+    }
+
+    size_t frames = images.size() * repeats;
+    candidate.precision = matched > 0 ? static_cast<double>(correct) / matched : 0.0;
+    candidate.recall = expected > 0 ? static_cast<double>(found) / expected : 0.0;
+    candidate.f1 = candidate.precision + candidate.recall > 0
+                       ? 2 * candidate.precision * candidate.recall / (candidate.precision + candidate.recall)
+                       : 0.0;
+    candidate.contours = contours / frames;
+    candidate.milliseconds = 1000 * seconds / frames;
+}
+
+void printCandidate(const Candidate &candidate)
+{
+    std::cout << std::right << std::fixed << std::setprecision(0) << std::setw(6) << candidate.canny.low
+              << std::setw(6) << candidate.canny.high << std::setw(6) << candidate.saturationShift
+              << std::setw(6) << candidate.minValue << std::setprecision(3) << std::setw(11) << candidate.precision
+              << std::setw(9) << candidate.recall << std::setw(9) << candidate.f1 << std::setprecision(1)
+              << std::setw(10) << candidate.contours << std::setprecision(3) << std::setw(10) << candidate.milliseconds
+              << (candidate.shortlisted ? "" : " (sweep)") << '\n';
+}
+
+void printUsage()
+{
+    std::cout << "Usage: ShapeDetectorTune [options]\n"
+              << "  --labels <file>       labelled images, lines of image,shape,color,x,y,width,height\n"
+              << "                        (default: synthetic scenes)\n"
+              << "  --width <px>          synthetic scene width (default 1280)\n"
+              << "  --height <px>         synthetic scene height (default 720)\n"
+              << "  --shapes <n>          shapes per synthetic scene (default 20)\n"
+              << "  --noise <sigma>       Gaussian noise per channel of synthetic scenes (default 8)\n"
+              << "  --scenes <n>          synthetic scenes (default 8)\n"
+              << "  --seed <n>            random seed (default 1)\n"
+              << "  --color-config <f>    color classes to start from (default: built-in classes)\n"
+              << "  --canny-low <l>       comma separated low Canny thresholds (default 50,100,150)\n"
+              << "  --canny-high <l>      comma separated high Canny thresholds (default 100,200,300)\n"
+              << "  --saturation <l>      comma separated shifts of the lower saturation bounds (default -10,0,10,20)\n"
+              << "  --value <l>           comma separated lower value bounds (default 24,44,64,84)\n"
+              << "  --tolerance <f>       F1 below the best that still counts as best (default 0.01)\n"
+              << "  --repeats <n>         timed passes over the images per shortlisted candidate (default 3)\n"
+              << "  --top <n>             candidates printed (default 10)\n"
+              << "  --output <file>       profile to write (default profile.yml)\n";
+}
+}
+
+int main(int argc, char **argv)
+{
+    SceneConfig sceneConfig;
+    sceneConfig.noise = 8.0;
+    int scenes = 8;
+    std::string labelsPath;
+    std::vector<int> cannyLows = {50, 100, 150};
+    std::vector<int> cannyHighs = {100, 200, 300};
+    std::vector<int> saturationShifts = {-10, 0, 10, 20};
+    std::vector<int> minValues = {24, 44, 64, 84};
+    double tolerance = 0.01;
+    int repeats = 3;
+    size_t top = 10;
+    std::string output = "profile.yml";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--help" || i + 1 >= argc)
+        {
+            printUsage();
+            return option == "--help" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+
+        try
+        {
+            if (option == "--labels")
+                labelsPath = value;
+            else if (option == "--width")
+                sceneConfig.size.width = std::stoi(value);
+            else if (option == "--height")
+                sceneConfig.size.height = std::stoi(value);
+            else if (option == "--shapes")
+                sceneConfig.shapes = std::stoi(value);
+            else if (option == "--noise")
+                sceneConfig.noise = std::stod(value);
+            else if (option == "--scenes")
+                scenes = std::max(1, std::stoi(value));
+            else if (option == "--seed")
+                sceneConfig.seed = std::stoull(value);
+            else if (option == "--canny-low")
+                cannyLows = parseList(value);
+            else if (option == "--canny-high")
+                cannyHighs = parseList(value);
+            else if (option == "--saturation")
+                saturationShifts = parseList(value);
+            else if (option == "--value")
+                minValues = parseList(value);
+            else if (option == "--tolerance")
+                tolerance = std::stod(value);
+            else if (option == "--repeats")
+                repeats = std::max(1, std::stoi(value));
+            else if (option == "--top")
+                top = static_cast<size_t>(std::max(1, std::stoi(value)));
+            else if (option == "--output")
+                output = value;
+            else if (option == "--color-config")
+            {
+                if (!ColorTable::shared().load(value))
+                    return 1;
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+        catch (const std::logic_error &)
+        {
+            std::cerr << "Invalid value for option " << option << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<LabelledImage> images;
+    if (!labelsPath.empty())
+    {
+        if (!loadLabels(labelsPath, images))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        SceneGenerator generator(sceneConfig);
+        images.resize(scenes);
+        for (LabelledImage &labelled : images)
+        {
+            generator.generate(labelled.image, labelled.truth);
+        }
+    }
+    if (images.empty())
+    {
+        std::cerr << "Error: no images to tune on" << std::endl;
+        return 1;
+    }
+    size_t shapes = 0;
+    for (const LabelledImage &labelled : images)
+    {
+        shapes += labelled.truth.size();
+    }
+
+    // Every candidate starts from the configured classes; hues stay as configured, since they
+    // decide which color a shape is, while the saturation and value floors decide what is masked in.
+    std::vector<Candidate> candidates;
+    for (int low : cannyLows)
+    {
+        for (int high : cannyHighs)
+        {
+            if (low <= 0 || high < low)
+            {
+                continue;
+            }
+            for (int shift : saturationShifts)
+            {
+                for (int minValue : minValues)
+                {
+                    std::vector<ColorClass> classes = ColorTable::shared().getClasses();
+                    for (ColorClass &color : classes)
+                    {
+                        color.lower[1] = cv::saturate_cast<uchar>(std::min(color.lower[1] + shift, static_cast<int>(color.upper[1])));
+                        color.lower[2] = cv::saturate_cast<uchar>(std::min(minValue, static_cast<int>(color.upper[2])));
+                    }
+
+                    Candidate candidate;
+                    candidate.canny.low = low;
+                    candidate.canny.high = high;
+                    candidate.saturationShift = shift;
+                    candidate.minValue = minValue;
+                    candidate.table.setClasses(classes);
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+    }
+    if (candidates.empty())
+    {
+        std::cerr << "Error: no valid parameter combinations, every high Canny threshold is below the low ones" << std::endl;
+        return 1;
+    }
+
+    // Candidates are scored in parallel; each has its own detector and color table.
+    int64 sweepBegin = cv::getTickCount();
+    cv::parallel_for_(cv::Range(0, static_cast<int>(candidates.size())), [&](const cv::Range &range)
+                      {
+                          for (int c = range.start; c < range.end; c++)
+                          {
+                              evaluate(candidates[c], images, 1);
+                          } });
+    double sweepSeconds = (cv::getTickCount() - sweepBegin) / cv::getTickFrequency();
+
+    // Latencies measured during the sweep include contention between candidates, so the
+    // candidates that tie for the best F1 are timed again one at a time before picking the fastest.
+    double bestF1 = 0.0;
+    for (const Candidate &candidate : candidates)
+    {
+        bestF1 = std::max(bestF1, candidate.f1);
+    }
+    for (Candidate &candidate : candidates)
+    {
+        if (candidate.f1 >= bestF1 - tolerance)
+        {
+            candidate.shortlisted = true;
+            evaluate(candidate, images, repeats);
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b)
+                     {
+                         if (a.shortlisted != b.shortlisted)
+                             return a.shortlisted;
+                         if (a.shortlisted)
+                             return a.milliseconds < b.milliseconds;
+                         return a.f1 > b.f1; });
+
+    std::cout << "Sweep: " << candidates.size() << " candidates over " << images.size() << " images (" << shapes
+              << " shapes), " << cv::getNumThreads() << " threads, " << std::fixed << std::setprecision(1)
+              << sweepSeconds << " s\n\n";
+    std::cout << std::right << std::setw(6) << "low" << std::setw(6) << "high" << std::setw(6) << "sat" << std::setw(6)
+              << "val" << std::setw(11) << "precision" << std::setw(9) << "recall" << std::setw(9) << "f1"
+              << std::setw(10) << "contours" << std::setw(10) << "ms" << '\n';
+    for (size_t c = 0; c < std::min(top, candidates.size()); c++)
+    {
+        printCandidate(candidates[c]);
+    }
+
+    const Candidate &best = candidates.front();
+    DetectorProfile profile;
+    profile.setCanny(best.canny);
+    profile.setColors(best.table.getClasses());
+    if (!profile.save(output))
+    {
+        return 1;
+    }
+    std::cout << "\nWrote " << output << ": Canny " << best.canny.low << "/" << best.canny.high << ", saturation shift "
+              << best.saturationShift << ", value floor " << best.minValue << std::endl;
+
+    return 0;
+}